@@ -5,411 +5,2735 @@
 #include <vector>
 #include <limits>
 #include <memory>
+#include <algorithm>
+#include <iterator>
 
 #include <cstdio>
 #include <cstring>
 #include <cstdint>
 #include <cmath>
 #include <cctype>
+#include <type_traits>
+#include <deque>
+#include <forward_list>
+#include <map>
+#include <mutex>
+#include <system_error>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#define BIGINT_HAS_PMR 1
+#endif
+#endif
+
+#if !defined(BIGINT_NO_SIMD)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#endif
+
+
+constexpr size_t bigint_log2(uint64_t val) {
+    return val > 1 ? 1 + bigint_log2(val >> 1) : 0;
+}
+
+// Copies the bit string held in src[0..n) as src_bits-wide words into dst[0..dn)
+// as dst_bits-wide words, both least significant first; zero-fills the tail of dst
+template<typename Out, typename In>
+void bigint_repack_bits(const In *src, size_t n, size_t src_bits, Out *dst, size_t dn, size_t dst_bits) {
+    const uint64_t mask = ((uint64_t)1 << dst_bits) - 1;
+    uint64_t acc = 0;
+    size_t acc_bits = 0;
+    size_t j = 0;
+    for(size_t i=0;i<n && j<dn;++i) {
+        acc |= (uint64_t)src[i] << acc_bits;
+        acc_bits += src_bits;
+        for(;acc_bits >= dst_bits && j<dn;acc_bits -= dst_bits,acc >>= dst_bits) {
+            dst[j++] = acc & mask;
+        }
+    }
+    if(j < dn && acc_bits) {
+        dst[j++] = acc & mask;
+    }
+    std::fill(dst+j,dst+dn,0);
+}
+
+// Decimal digit kernels for parsing and printing. SIMD versions are used when the
+// compiler targets the instruction set, SWAR or plain loops otherwise; defining
+// BIGINT_NO_SIMD forces the portable code.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && !defined(BIGINT_NO_SIMD)
+#define BIGINT_SWAR 1
+#endif
+
+// Number of leading characters of p[0..n) that are digits below radix <= 10
+inline size_t bigint_scan_decimal(const char *p, size_t n, unsigned radix) {
+    size_t i = 0;
+#if defined(__AVX2__) && !defined(BIGINT_NO_SIMD)
+    const __m256i zero32 = _mm256_set1_epi8('0'), top32 = _mm256_set1_epi8(radix-1);
+    for(;i+32 <= n;i += 32) {
+        const __m256i v = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i*)(p+i)),zero32);
+        const uint32_t valid = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(v,top32),v));
+        if(valid != 0xFFFFFFFF) {
+            return i + __builtin_ctz(~valid);
+        }
+    }
+#endif
+#if defined(__SSE2__) && !defined(BIGINT_NO_SIMD)
+    const __m128i zero = _mm_set1_epi8('0'), top = _mm_set1_epi8(radix-1);
+    for(;i+16 <= n;i += 16) {
+        const __m128i v = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)(p+i)),zero);
+        const uint32_t valid = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v,top),v));
+        if(valid != 0xFFFF) {
+            return i + __builtin_ctz(~valid);
+        }
+    }
+#endif
+    for(;i < n && (unsigned char)(p[i]-'0') < radix;++i);
+    return i;
+}
+
+// Value of the 8 decimal digits p[0..8)
+inline uint32_t bigint_parse_decimal8(const char *p) {
+#if defined(__SSE4_1__) && !defined(BIGINT_NO_SIMD)
+    __m128i v = _mm_sub_epi8(_mm_loadl_epi64((const __m128i*)p),_mm_set1_epi8('0'));
+    v = _mm_maddubs_epi16(v,_mm_setr_epi8(10,1,10,1,10,1,10,1,10,1,10,1,10,1,10,1));
+    v = _mm_madd_epi16(v,_mm_setr_epi16(100,1,100,1,100,1,100,1));
+    v = _mm_packus_epi32(v,v);
+    v = _mm_madd_epi16(v,_mm_setr_epi16(10000,1,10000,1,10000,1,10000,1));
+    return _mm_cvtsi128_si32(v);
+#elif defined(BIGINT_SWAR)
+    uint64_t v;
+    memcpy(&v,p,8);
+    v = (v & 0x0F0F0F0F0F0F0F0F)*2561 >> 8;
+    v = (v & 0x00FF00FF00FF00FF)*6553601 >> 16;
+    return (v & 0x0000FFFF0000FFFF)*42949672960001 >> 32;
+#else
+    uint32_t v = 0;
+    for(size_t i=0;i<8;++i) {
+        v = v*10 + (p[i]-'0');
+    }
+    return v;
+#endif
+}
+
+// Writes x < 10^9 as exactly 9 decimal digits to out
+inline void bigint_format_decimal9(uint32_t x, char *out) {
+    out[0] = '0' + x/100000000;
+    x %= 100000000;
+#if defined(__SSE2__) && !defined(BIGINT_NO_SIMD)
+    // four groups of 4 digits -> 8 pairs of 2 -> 16 digits in 16-bit lanes
+    const __m128i groups = _mm_setr_epi16(x/10000,x%10000,0,0,0,0,0,0);
+    const __m128i hundreds = _mm_srli_epi16(_mm_mulhi_epu16(groups,_mm_set1_epi16(5243)),3);
+    const __m128i pairs = _mm_unpacklo_epi16(hundreds,_mm_sub_epi16(groups,_mm_mullo_epi16(hundreds,_mm_set1_epi16(100))));
+    const __m128i tens = _mm_mulhi_epu16(pairs,_mm_set1_epi16(6554));
+    const __m128i ones = _mm_sub_epi16(pairs,_mm_mullo_epi16(tens,_mm_set1_epi16(10)));
+    const __m128i ascii = _mm_add_epi8(_mm_or_si128(tens,_mm_slli_epi16(ones,8)),_mm_set1_epi8('0'));
+    _mm_storel_epi64((__m128i*)(out+1),ascii);
+#elif defined(BIGINT_SWAR)
+    // the same split in 32-bit and 16-bit fields of one word
+    const uint64_t merged = x/10000 | (uint64_t)(x%10000) << 32;
+    const uint64_t top = ((merged*10486) >> 20) & (0x7Full << 32 | 0x7F);
+    const uint64_t pairs = ((merged - 100*top) << 16) + top;
+    uint64_t tens = ((pairs*103) >> 10) & (0xFull << 48 | 0xFull << 32 | 0xFull << 16 | 0xF);
+    tens += (pairs - 10*tens) << 8;
+    tens += 0x3030303030303030;
+    memcpy(out+1,&tens,8);
+#else
+    for(size_t i=8;i > 0;--i,x /= 10) {
+        out[i] = '0' + x%10;
+    }
+#endif
+}
+
+// Number-theoretic transform modulo the prime P < 2^31 with primitive root G.
+// Twiddles are kept in Montgomery form (times 2^32) so every butterfly needs a
+// Montgomery reduction instead of a 64-bit modulo.
+template<uint32_t P, uint32_t G>
+struct bigint_ntt {
+    // -P^-1 mod 2^32 by Newton iteration
+    static constexpr uint32_t neg_inverse() {
+        uint32_t inv = P;
+        for(int i=0;i<4;++i) {
+            inv *= 2 - P*inv;
+        }
+        return -inv;
+    }
+
+    static constexpr uint32_t pinv = neg_inverse();
+
+    // a*b/2^32 mod P for a*b < P*2^32
+    static inline uint32_t mont_mul(uint32_t a, uint32_t b) {
+        const uint64_t t = (uint64_t)a*b;
+        const uint32_t m = (uint32_t)t*pinv;
+        return reduce((t + (uint64_t)m*P) >> 32);
+    }
+
+    // x mod P for x < 2P, without a data-dependent branch
+    static inline uint32_t reduce(uint32_t x) {
+        return std::min(x,x-P);
+    }
+
+    static uint32_t to_mont(uint32_t a) {
+        return ((uint64_t)a << 32) % P;
+    }
+
+    static uint32_t power(uint32_t base, uint64_t e) {
+        uint64_t result = 1;
+        for(;e;e >>= 1,base = (uint64_t)base*base % P) {
+            if(e & 1) {
+                result = result*base % P;
+            }
+        }
+        return result;
+    }
+
+    // roots[half+j] = w^j for the primitive (2*half)-th root of unity w, all half < n,
+    // in Montgomery form
+    static std::vector<uint32_t> root_table(size_t n, bool inverse) {
+        std::vector<uint32_t> roots(std::max<size_t>(n,2));
+        for(size_t half=1;half<n;half <<= 1) {
+            const uint64_t e = (P-1)/(2*half);
+            const uint32_t w = to_mont(power(G,inverse ? P-1-e : e));
+            roots[half] = to_mont(1);
+            for(size_t j=1;j<half;++j) {
+                roots[half+j] = mont_mul(roots[half+j-1],w);
+            }
+        }
+        return roots;
+    }
+
+    static inline void forward_butterflies(uint32_t *a, size_t half, const uint32_t *w) {
+        uint32_t *hi = a+half;
+        for(size_t j=0;j<half;++j) {
+            const uint32_t u = a[j], v = hi[j];
+            a[j] = reduce(u+v);
+            hi[j] = mont_mul(u+P-v,w[j]);
+        }
+    }
+
+    static inline void inverse_butterflies(uint32_t *a, size_t half, const uint32_t *w) {
+        uint32_t *hi = a+half;
+        for(size_t j=0;j<half;++j) {
+            const uint32_t u = a[j], v = mont_mul(hi[j],w[j]);
+            a[j] = reduce(u+v);
+            hi[j] = reduce(u+P-v);
+        }
+    }
+
+    // Transforms below this many points run level by level, larger ones split
+    // recursively so that the inner levels stay in cache
+    static const size_t cache_block = 4096;
+
+    // Forward transform of a[0..n), n a power of two dividing P-1, with roots from
+    // root_table(n,false). Decimation in frequency, so the output is left in
+    // bit-reversed order; inverse() expects that order, and pointwise products do
+    // not care.
+    static void forward(uint32_t *a, size_t n, const uint32_t *roots) {
+        if(n > cache_block) {
+            forward_butterflies(a,n/2,roots+n/2);
+            forward(a,n/2,roots);
+            forward(a+n/2,n/2,roots);
+            return;
+        }
+
+        for(size_t len=n;len >= 2;len >>= 1) {
+            for(size_t i=0;i<n;i+=len) {
+                forward_butterflies(a+i,len/2,roots+len/2);
+            }
+        }
+    }
+
+    // Inverse of forward() up to the factor n, decimation in time, with roots from
+    // root_table(n,true)
+    static void inverse(uint32_t *a, size_t n, const uint32_t *roots) {
+        if(n > cache_block) {
+            inverse(a,n/2,roots);
+            inverse(a+n/2,n/2,roots);
+            inverse_butterflies(a,n/2,roots+n/2);
+            return;
+        }
+
+        for(size_t len=2;len <= n;len <<= 1) {
+            for(size_t i=0;i<n;i+=len) {
+                inverse_butterflies(a+i,len/2,roots+len/2);
+            }
+        }
+    }
+
+    // Cyclic convolution modulo P of a and b zero-padded to n. Passing the same
+    // vector twice squares it with a single forward transform.
+    static std::vector<uint32_t> convolve(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b, size_t n) {
+        const std::vector<uint32_t> roots = root_table(n,false);
+
+        std::vector<uint32_t> fa(n);
+        for(size_t i=0;i<a.size();++i) {
+            fa[i] = a[i] % P;
+        }
+        forward(fa.data(),n,roots.data());
+
+        if(&a == &b) {
+            for(size_t i=0;i<n;++i) {
+                fa[i] = mont_mul(fa[i],fa[i]);
+            }
+        } else {
+            std::vector<uint32_t> fb(n);
+            for(size_t i=0;i<b.size();++i) {
+                fb[i] = b[i] % P;
+            }
+            forward(fb.data(),n,roots.data());
+            for(size_t i=0;i<n;++i) {
+                fa[i] = mont_mul(fa[i],fb[i]);
+            }
+        }
+
+        inverse(fa.data(),n,root_table(n,true).data());
+
+        // Undo the 2^-32 of the pointwise products together with the 1/n of the inverse
+        const uint32_t scale = to_mont(to_mont(power(n % P,P-2)));
+        for(size_t i=0;i<n;++i) {
+            fa[i] = mont_mul(fa[i],scale);
+        }
+
+        return fa;
+    }
+};
+
+template<uint32_t P, uint32_t G> constexpr uint32_t bigint_ntt<P,G>::pinv;
+template<uint32_t P, uint32_t G> const size_t bigint_ntt<P,G>::cache_block;
+
+// Exact product of coefficient vectors through three NTT primes and CRT. The
+// convolution terms must stay below the primes' product, about 2^87.
+struct bigint_ntt3 {
+    typedef bigint_ntt<2013265921,31> ntt1;
+    typedef bigint_ntt<469762049,3> ntt2;
+    typedef bigint_ntt<167772161,3> ntt3;
+
+    static const uint32_t p1 = 2013265921;
+    static const uint32_t p2 = 469762049;
+    static const uint32_t p3 = 167772161;
+
+    // Largest transform length all three primes support
+    static const size_t max_length = (size_t)1 << 25;
+
+    static bool fits(size_t an, size_t bn, uint64_t base) {
+        size_t len = 1;
+        for(;len < an+bn-1;len <<= 1);
+        const double max_term = (double)std::min(an,bn)*(double)(base-1)*(double)(base-1);
+        return len <= max_length && max_term < ldexp(1.0,86);
+    }
+
+    // a*b as a+b coefficients in Base, with carries propagated; a*a when both
+    // arguments are the same vector
+    template<uint64_t Base>
+    static std::vector<uint32_t> multiply(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b) {
+        size_t len = 1;
+        for(;len < a.size()+b.size()-1;len <<= 1);
+
+        const std::vector<uint32_t> r1 = ntt1::convolve(a,b,len);
+        const std::vector<uint32_t> r2 = ntt2::convolve(a,b,len);
+        const std::vector<uint32_t> r3 = ntt3::convolve(a,b,len);
+
+        const uint64_t p12 = (uint64_t)p1*p2;
+        const uint64_t inv_p1 = ntt2::power(p1 % p2,p2-2);
+        const uint64_t inv_p12 = ntt3::power(p12 % p3,p3-2);
+
+        std::vector<uint32_t> result(a.size()+b.size());
+        uint64_t carry[3] = {0,0,0};
+        for(size_t k=0;k<result.size();++k) {
+            uint64_t x[3] = {0,0,0};
+            if(k < len) {
+                // Garner: x = r1 + p1*t2 + p1*p2*t3
+                const uint64_t t2 = (r2[k] + p2 - r1[k] % p2) * inv_p1 % p2;
+                const uint64_t s = r1[k] + p1*t2;
+                const uint64_t t3 = (r3[k] + p3 - s % p3) * inv_p12 % p3;
+                const uint64_t lo = (p12 & 0xFFFFFFFF)*t3, hi = (p12 >> 32)*t3;
+                x[0] = (s & 0xFFFFFFFF) + (lo & 0xFFFFFFFF);
+                x[1] = (s >> 32) + (lo >> 32) + (hi & 0xFFFFFFFF) + (x[0] >> 32);
+                x[2] = (hi >> 32) + (x[1] >> 32);
+                x[0] &= 0xFFFFFFFF;
+                x[1] &= 0xFFFFFFFF;
+            }
+
+            x[0] += carry[0];
+            x[1] += carry[1] + (x[0] >> 32);
+            x[2] += carry[2] + (x[1] >> 32);
+
+            uint64_t rem = 0;
+            for(size_t i=3;i-- > 0;) {
+                const uint64_t current = rem << 32 | (x[i] & 0xFFFFFFFF);
+                carry[i] = current / Base;
+                rem = current % Base;
+            }
+            result[k] = rem;
+        }
+
+        return result;
+    }
+};
+
+// Division by a fixed d <= 2^32 with a precomputed reciprocal (Granlund & Moller,
+// "Improved division by invariant integers"): each step divides x < d*2^32 with
+// two multiplications and at most two adjustments instead of a 64-bit divide.
+struct bigint_limb_divisor {
+    uint64_t divisor;
+    uint32_t norm;
+    uint32_t inverse;
+    unsigned shift;
+    bool pow2;
+
+    explicit bigint_limb_divisor(uint64_t d):divisor(d),norm(0),inverse(0),shift(0) {
+        pow2 = (d & (d-1)) == 0;
+        if(pow2) {
+            shift = bigint_log2(d);
+            return;
+        }
+
+        for(;!((d << shift) & 0x80000000);++shift);
+        norm = d << shift;
+        inverse = ~(uint64_t)0 / norm - ((uint64_t)1 << 32);
+    }
+
+    // x / divisor for x < divisor*2^32; the remainder goes to rem
+    inline uint32_t divide(uint64_t x, uint64_t &rem) const {
+        if(pow2) {
+            rem = x & (divisor-1);
+            return x >> shift;
+        }
+
+        x <<= shift;
+        const uint32_t u1 = x >> 32, u0 = x;
+        const uint64_t q = (uint64_t)inverse*u1 + x;
+        uint32_t q1 = (q >> 32) + 1;
+        uint32_t r = u0 - q1*norm;
+        // the first adjustment is unpredictable, so it is done without a branch
+        const uint32_t mask = -(uint32_t)(r > (uint32_t)q);
+        q1 += mask;
+        r += mask & norm;
+        if(r >= norm) {
+            ++q1;
+            r -= norm;
+        }
+        rem = r >> shift;
+        return q1;
+    }
+};
+
+// Per-thread cache of freed limb buffers in power-of-two size classes, so the
+// temporaries of arithmetic reuse memory instead of going through malloc. A
+// buffer may be freed on any thread; it then joins that thread's cache.
+class bigint_limb_pool {
+    struct block {
+        block *next;
+    };
+
+    static const size_t min_class = 6;
+    static const size_t max_class = 20;
+    // each class caches at most this many bytes, and at least two buffers
+    static const size_t class_budget = (size_t)1 << 18;
+
+    block *free_list[max_class+1];
+    size_t cached[max_class+1];
+
+    static bool& destroyed() {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    bigint_limb_pool() {
+        std::fill(free_list,free_list+max_class+1,nullptr);
+        std::fill(cached,cached+max_class+1,0);
+    }
+
+    ~bigint_limb_pool() {
+        for(size_t k=min_class;k<=max_class;++k) {
+            while(block *b = free_list[k]) {
+                free_list[k] = b->next;
+                ::operator delete(b);
+            }
+        }
+        destroyed() = true;
+    }
+
+    // this thread's pool, or nullptr while the thread is shutting down
+    static bigint_limb_pool* local() {
+        if(destroyed()) {
+            return nullptr;
+        }
+        static thread_local bigint_limb_pool pool;
+        return &pool;
+    }
+
+    static size_t size_class(size_t bytes) {
+        size_t k = min_class;
+        for(;((size_t)1 << k) < bytes;++k);
+        return k;
+    }
+
+public:
+    static void* allocate(size_t bytes) {
+        const size_t k = size_class(bytes);
+        bigint_limb_pool *pool = k <= max_class ? local() : nullptr;
+        if(!pool) {
+            return ::operator new(k <= max_class ? (size_t)1 << k : bytes);
+        }
+
+        if(block *b = pool->free_list[k]) {
+            pool->free_list[k] = b->next;
+            --pool->cached[k];
+            return b;
+        }
+        return ::operator new((size_t)1 << k);
+    }
+
+    static void deallocate(void *p, size_t bytes) {
+        const size_t k = size_class(bytes);
+        bigint_limb_pool *pool = k <= max_class ? local() : nullptr;
+        if(!pool || pool->cached[k] >= std::max((size_t)2,class_budget >> k)) {
+            ::operator delete(p);
+            return;
+        }
+
+        block *b = static_cast<block*>(p);
+        b->next = pool->free_list[k];
+        pool->free_list[k] = b;
+        ++pool->cached[k];
+    }
+};
+
+// Stateless allocator over bigint_limb_pool, the default for limb storage
+template<typename T>
+struct bigint_pool_allocator {
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type is_always_equal;
+
+    bigint_pool_allocator() {
+
+    }
+
+    template<typename U>
+    bigint_pool_allocator(const bigint_pool_allocator<U> &) {
+
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(bigint_limb_pool::allocate(n*sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t n) {
+        bigint_limb_pool::deallocate(p,n*sizeof(T));
+    }
+
+    bool operator==(const bigint_pool_allocator &) const {
+        return true;
+    }
+
+    bool operator!=(const bigint_pool_allocator &) const {
+        return false;
+    }
+};
+
+// Limb storage with room for N limbs inside the object; longer values spill to
+// the heap through Alloc. Keeps the subset of the std::vector interface
+// basic_bigint uses, for trivially copyable T only, and follows the allocator
+// propagation rules of std::allocator_traits.
+template<typename T, size_t N, typename Alloc = std::allocator<T>>
+class bigint_limbs : private Alloc {
+    typedef std::allocator_traits<Alloc> traits;
+
+    T *ptr;
+    size_t count;
+    size_t cap;
+    T local[N];
+
+    bool is_local() const {
+        return ptr == local;
+    }
+
+    Alloc& allocator() {
+        return *this;
+    }
+
+    void release() {
+        if(!is_local()) {
+            traits::deallocate(allocator(),ptr,cap);
+        }
+        ptr = local;
+        cap = N;
+    }
+
+    void reallocate(size_t new_cap) {
+        T *p = traits::allocate(allocator(),new_cap);
+        if(count) {
+            memcpy(p,ptr,count*sizeof(T));
+        }
+        release();
+        ptr = p;
+        cap = new_cap;
+    }
+
+    void steal(bigint_limbs &other) {
+        release();
+        ptr = other.ptr;
+        cap = other.cap;
+        count = other.count;
+        other.ptr = other.local;
+        other.cap = N;
+        other.count = 0;
+    }
+
+    void assign_allocator(const Alloc &other, std::true_type) {
+        if(allocator() != other) {
+            release();
+        }
+        allocator() = other;
+    }
+
+    void assign_allocator(const Alloc &, std::false_type) {
+
+    }
+
+public:
+    typedef T value_type;
+    typedef Alloc allocator_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    explicit bigint_limbs(const Alloc &alloc = Alloc()):Alloc(alloc),ptr(local),count(0),cap(N) {
+
+    }
+
+    bigint_limbs(size_t n, T val = T(), const Alloc &alloc = Alloc()):bigint_limbs(alloc) {
+        assign(n,val);
+    }
+
+    bigint_limbs(const bigint_limbs &other):bigint_limbs(traits::select_on_container_copy_construction(other.get_allocator())) {
+        assign(other.begin(),other.end());
+    }
+
+    // A local buffer always fits the local buffer of the new value, so moving never allocates
+    bigint_limbs(bigint_limbs &&other) noexcept:bigint_limbs(other.get_allocator()) {
+        if(other.is_local()) {
+            assign(other.begin(),other.end());
+            other.count = 0;
+        } else {
+            steal(other);
+        }
+    }
+
+    ~bigint_limbs() {
+        release();
+    }
+
+    allocator_type get_allocator() const {
+        return *this;
+    }
+
+    bigint_limbs& operator=(const bigint_limbs &other) {
+        if(this != &other) {
+            assign_allocator(other.get_allocator(),typename traits::propagate_on_container_copy_assignment());
+            assign(other.begin(),other.end());
+        }
+        return *this;
+    }
+
+    // Takes over other's buffer when the allocators allow it, copies otherwise
+    bigint_limbs& operator=(bigint_limbs &&other) noexcept(traits::propagate_on_container_move_assignment::value || traits::is_always_equal::value) {
+        if(this == &other) {
+            return *this;
+        }
+        assign_allocator(other.get_allocator(),typename traits::propagate_on_container_move_assignment());
+        if(other.is_local() || allocator() != other.allocator()) {
+            assign(other.begin(),other.end());
+            other.count = 0;
+        } else {
+            steal(other);
+        }
+        return *this;
+    }
+
+    void swap(bigint_limbs &other) {
+        bigint_limbs tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return !count; }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+
+    iterator begin() { return ptr; }
+    iterator end() { return ptr+count; }
+    const_iterator begin() const { return ptr; }
+    const_iterator end() const { return ptr+count; }
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    T& back() { return ptr[count-1]; }
+    const T& back() const { return ptr[count-1]; }
+
+    void reserve(size_t n) {
+        if(n > cap) {
+            reallocate(n);
+        }
+    }
+
+    void resize(size_t n, T val = T()) {
+        reserve(n);
+        if(n > count) {
+            std::fill(ptr+count,ptr+n,val);
+        }
+        count = n;
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    void push_back(T val) {
+        if(count == cap) {
+            reallocate(2*cap);
+        }
+        ptr[count++] = val;
+    }
+
+    void pop_back() {
+        --count;
+    }
+
+    void assign(size_t n, T val) {
+        count = 0;
+        resize(n,val);
+    }
+
+    template<typename It>
+    void assign(It first, It last) {
+        const size_t n = std::distance(first,last);
+        count = 0;
+        reserve(n);
+        std::copy(first,last,ptr);
+        count = n;
+    }
+
+    bool operator==(const bigint_limbs &other) const {
+        return count == other.count && std::equal(begin(),end(),other.begin());
+    }
+
+    bool operator!=(const bigint_limbs &other) const {
+        return !(*this == other);
+    }
+};
+
+// Same as std::to_chars_result, which needs C++17
+struct bigint_to_chars_result {
+    char *ptr;
+    std::errc ec;
+};
+
+// Same as std::from_chars_result
+struct bigint_from_chars_result {
+    const char *ptr;
+    std::errc ec;
+};
+
+template<uint64_t Radix, typename Limb = uint32_t, typename Alloc = bigint_pool_allocator<Limb>>
+struct basic_bigint_divisor;
+
+template<typename V, typename E>
+struct bigint_expr;
+
+template<typename V>
+struct bigint_expr_value;
+
+// Unsigned integer stored as little-endian digits in base Radix, each digit held
+// in one Limb. Radix is a compile-time constant, so carries and digit splits
+// compile down to shifts (Radix == 2^bits of Limb) or multiply-by-reciprocal.
+// Values in different radices are distinct types and convert only explicitly.
+template<uint64_t Radix, typename Limb = uint32_t, typename Alloc = bigint_pool_allocator<Limb>>
+struct basic_bigint {
+    typedef Limb digit_t;
+    typedef uint64_t radix_t;
+    typedef Alloc allocator_type;
+
+    static_assert(std::is_unsigned<Limb>::value && sizeof(Limb) <= 4,"limbs must be unsigned and at most 32 bits wide");
+
+    static const size_t digit_bits = sizeof(digit_t)*8;
+    static const radix_t native_radix = (radix_t)1 << digit_bits;
+    static const radix_t radix = Radix;
+
+    static_assert(Radix >= 2 && Radix <= native_radix,"radix must fit into a single limb");
+
+    static const bool radix_is_pow2 = (Radix & (Radix-1)) == 0;
+    static const size_t radix_bits = bigint_log2(Radix);
+
+    // Limbs kept inline before spilling to the heap: 128 bits
+    static const size_t inline_limbs = 16/sizeof(Limb);
+
+    bigint_limbs<digit_t,inline_limbs,Alloc> digits;
+
+    // The same number type with the default allocator. Conversions run on it, so
+    // the shared power tables never hold memory from a caller's allocator.
+    typedef basic_bigint<Radix,Limb> plain_t;
+    static const bool plain_alloc = std::is_same<Alloc,bigint_pool_allocator<Limb>>::value;
+
+    // Scratch space of the kernels, drawn from the thread's limb pool
+    typedef std::vector<digit_t,bigint_pool_allocator<digit_t>> scratch_t;
+    typedef std::vector<uint32_t,bigint_pool_allocator<uint32_t>> chunks_t;
+
+    // Splits a double-width value into the digit that stays in place and the carry
+    // into the next one. In native radix this is a shift and a mask, not a divide.
+    static inline digit_t split_digit(uint64_t val, uint64_t &carry) {
+        if(radix == native_radix) {
+            carry = val >> digit_bits;
+            return (digit_t)val;
+        }
+        carry = val / radix;
+        return val % radix;
+    }
+
+    void erase_leading_zeros() {
+        auto i = digits.rbegin();
+        for(;i != digits.rend() && !*i;++i);
+        digits.resize(digits.rend() - i);
+    }
+
+    inline size_t rank() const {
+        return digits.size();
+    }
+
+    allocator_type get_allocator() const {
+        return digits.get_allocator();
+    }
+
+    basic_bigint(uint64_t val, size_t rank, const Alloc &alloc = Alloc()):digits(alloc) {
+        if(!val) {
+            digits.reserve(rank);
+        } else {
+            digits.reserve((64+radix_bits-1)/radix_bits+rank);
+            while(rank--) {
+                digits.push_back(0);
+            }
+            while(val) {
+                digits.push_back(split_digit(val,val));
+            }
+        }
+    }
+
+    basic_bigint() {
+
+    }
+
+    explicit basic_bigint(const Alloc &alloc):digits(alloc) {
+
+    }
+
+    basic_bigint(uint64_t val):basic_bigint(val,0) {
+
+    }
+
+    // Value of the longest prefix of s made of digits in _radix, zero when s does
+    // not start with one: "12x34" is 12 and "-5" is 0
+#if __cplusplus >= 201703L
+    basic_bigint(std::string_view s,digit_t _radix) {
+#else
+    basic_bigint(const std::string &s,digit_t _radix) {
+#endif
+        from_chars(s.data(),s.data()+s.size(),_radix);
+    }
+
+    typedef bigint_from_chars_result from_chars_result;
+
+    // Parses the longest prefix of [first,last) made of digits in view_radix <= 62
+    // (0-9A-Za-z) into this value. Like std::from_chars, returns where parsing
+    // stopped, or first and std::errc::invalid_argument with the value unchanged
+    // when there are no digits.
+    from_chars_result from_chars(const char *first, const char *last, radix_t view_radix=10) {
+        return from_chars(first,last,view_radix,std::integral_constant<bool,plain_alloc>());
+    }
+
+    // Other allocators parse on plain_t: the conversion temporaries come from the
+    // limb pool and only the result uses the allocator
+    from_chars_result from_chars(const char *first, const char *last, radix_t view_radix, std::false_type) {
+        plain_t value;
+        const from_chars_result parsed = value.from_chars(first,last,view_radix);
+        if(parsed.ec == std::errc()) {
+            digits.assign(value.digits.begin(),value.digits.end());
+        }
+        return parsed;
+    }
+
+    from_chars_result from_chars(const char *first, const char *last, radix_t view_radix, std::true_type) {
+        const size_t size = last - first;
+        size_t len = 0;
+        if(view_radix <= 10) {
+            len = bigint_scan_decimal(first,size,view_radix);
+        } else {
+            for(;len < size && char_value(first[len]) < view_radix;++len);
+        }
+        if(!len) {
+            return {first,std::errc::invalid_argument};
+        }
+
+        if(radix_is_pow2 && is_pow2(view_radix)) {
+            // bits of the characters go straight into limbs, last character first
+            const size_t bits = bigint_log2(view_radix);
+            digits.assign((len*bits+radix_bits-1)/radix_bits,0);
+            uint64_t acc = 0;
+            size_t acc_bits = 0, j = 0;
+            for(size_t k=len;k-- > 0;) {
+                acc |= (uint64_t)char_value(first[k]) << acc_bits;
+                for(acc_bits += bits;acc_bits >= radix_bits;acc_bits -= radix_bits,acc >>= radix_bits) {
+                    digits[j++] = acc & (radix-1);
+                }
+            }
+            if(acc_bits) {
+                digits[j] = acc;
+            }
+            erase_leading_zeros();
+            return {first+len,std::errc()};
+        }
+
+        // Characters are read per_chunk at a time into a word, last chunk first
+        size_t per_chunk;
+        const uint64_t base = radix_chunk(view_radix,per_chunk);
+        chunks_t chunks((len+per_chunk-1)/per_chunk);
+        size_t j = 0, end = len;
+        if(view_radix == 10) {
+            for(;end >= 9;++j,end -= 9) {
+                chunks[j] = (first[end-9]-'0')*100000000 + bigint_parse_decimal8(first+end-8);
+            }
+        }
+        for(;j<chunks.size();++j,end-=per_chunk) {
+            uint32_t word = 0;
+            for(size_t k=end > per_chunk ? end-per_chunk : 0;k<end;++k) {
+                word = word*view_radix + char_value(first[k]);
+            }
+            chunks[j] = word;
+        }
+
+        *this = from_chunks(chunks.data(),chunks.size(),base,view_radix);
+        return {first+len,std::errc()};
+    }
+
+    // Digit value of c in the ASCII 0-9A-Za-z alphabet, 255 for anything else
+    // including bytes >= 0x80; independent of the locale
+    static inline unsigned char_value(char c) {
+        const unsigned char u = (unsigned char)c;
+        if((unsigned char)(u - '0') < 10) {
+            return u - '0';
+        } else if((unsigned char)(u - 'A') < 26) {
+            return u - 'A' + 10;
+        } else if((unsigned char)(u - 'a') < 26) {
+            return u - 'a' + 36;
+        }
+        return 255;
+    }
+
+    template<uint64_t OtherRadix, typename OtherLimb, typename OtherAlloc>
+    explicit basic_bigint(const basic_bigint<OtherRadix,OtherLimb,OtherAlloc> &other, const Alloc &alloc = Alloc()):digits(alloc) {
+        if(OtherRadix == radix) {
+            digits.assign(other.digits.begin(),other.digits.end());
+            return;
+        }
+
+        assign_digits(other.digits.data(),other.rank(),OtherRadix);
+    }
+
+    // Evaluates a lazy expression, see bigint_expr
+    template<typename E>
+    basic_bigint(const bigint_expr<basic_bigint,E> &e):digits(e.self().get_allocator()) {
+        e.evaluate(*this,false,false);
+    }
+
+    template<typename E>
+    basic_bigint& operator=(const bigint_expr<basic_bigint,E> &e) {
+        e.evaluate(*this,false,false);
+        return *this;
+    }
+
+    template<typename E>
+    basic_bigint& operator+=(const bigint_expr<basic_bigint,E> &e) {
+        e.evaluate(*this,true,false);
+        return *this;
+    }
+
+    template<typename E>
+    basic_bigint& operator-=(const bigint_expr<basic_bigint,E> &e) {
+        e.evaluate(*this,true,true);
+        return *this;
+    }
+
+    // Starts a lazy expression: a.lazy() + b.lazy()*c - d builds no intermediate values
+    bigint_expr_value<basic_bigint> lazy() const {
+        return bigint_expr_value<basic_bigint>(*this);
+    }
+
+    // this = this*m + a for m, a <= native_radix, in place
+    void mul_add(uint64_t m, uint64_t a) {
+        uint64_t extra = a;
+        for(auto &i: digits) {
+            i = split_digit((uint64_t)i*m + extra,extra);
+        }
+        while(extra) {
+            digits.push_back(split_digit(extra,extra));
+        }
+    }
+
+    // Takes over a result computed on plain_t: moved in when this is plain_t,
+    // copied into this value's allocator otherwise
+    void assign_plain(plain_t &&value) {
+        assign_plain(value,std::integral_constant<bool,plain_alloc>());
+    }
+
+    void assign_plain(plain_t &value, std::true_type) {
+        digits.swap(value.digits);
+    }
+
+    void assign_plain(plain_t &value, std::false_type) {
+        digits.assign(value.digits.begin(),value.digits.end());
+    }
+
+    int compare(const basic_bigint &other) const {
+        if(rank() == other.rank()) {
+            auto a = digits.rbegin();
+            auto b = other.digits.rbegin();
+            for(;a != digits.rend() && *a == *b;++a,++b);
+
+            if(a == digits.rend()) {
+                return 0;
+            }
+
+            return *a < *b ? -1 : 1;
+        } else {
+            return rank() - other.rank();
+        }
+    }
+
+    inline bool operator<(const basic_bigint &other) const {
+        return compare(other) < 0;
+    }
+
+    inline bool operator>(const basic_bigint &other) const {
+        return compare(other) > 0;
+    }
+
+    inline bool operator<=(const basic_bigint &other) const {
+        return compare(other) <= 0;
+    }
+
+    inline bool operator>=(const basic_bigint &other) const {
+        return compare(other) >= 0;
+    }
+
+    inline bool operator==(const basic_bigint &other) const {
+        return compare(other) == 0;
+    }
+
+    inline bool operator!=(const basic_bigint &other) const {
+        return compare(other) != 0;
+    }
+
+    basic_bigint& operator+=(const basic_bigint &other) {
+        if(rank() < other.rank()) {
+            digits.reserve(other.rank()+1);
+            digits.resize(other.rank());
+        }
+
+        auto a = digits.begin();
+        auto b = other.digits.begin();
+
+        uint64_t extra = 0;
+        for(;a != digits.end() && b != other.digits.end();++a,++b) {
+            *a = split_digit((uint64_t)*a + *b + extra,extra);
+        }
+
+        for(;extra && a != digits.end();++a) {
+            *a = split_digit((uint64_t)*a + extra,extra);
+        }
+
+        if(extra && a == digits.end()) {
+            digits.push_back(extra);
+        }
+
+        return *this;
+    }
+
+    basic_bigint& operator-=(const basic_bigint &other) {
+        if(rank() < other.rank()) {
+            digits.reserve(other.rank()+1);
+        }
+
+        auto a = digits.begin();
+        auto b = other.digits.begin();
+
+        uint64_t extra = 0;
+        for(;a != digits.end() && b != other.digits.end();++a,++b) {
+            *a = split_digit(radix + *a - *b - extra,extra);
+            extra = 1 - extra;
+        }
+
+        for(;extra && a != digits.end();++a) {
+            *a = split_digit(radix + *a - extra,extra);
+            extra = 1 - extra;
+        }
+
+        for(;b != other.digits.end();++b) {
+            digits.push_back(split_digit(radix - *b - extra,extra));
+            extra = 1 - extra;
+        }
+
+        if(extra && a == digits.end()) {
+            digits.push_back(radix-1);
+        }
+
+        erase_leading_zeros();
+
+        return *this;
+    }
+
+    basic_bigint operator+(const basic_bigint &other) const & {
+        basic_bigint sum(0,std::max(rank(),other.rank())+1,get_allocator());
+        sum.digits.assign(digits.begin(),digits.end());
+        sum += other;
+        return sum;
+    }
+
+    // A temporary operand lends its buffer to the result, so chains like
+    // a + b + c - d grow one buffer instead of allocating at every step
+    basic_bigint operator+(const basic_bigint &other) && {
+        *this += other;
+        return std::move(*this);
+    }
+
+    basic_bigint operator+(basic_bigint &&other) const & {
+        if(other.get_allocator() != get_allocator()) {
+            return *this + static_cast<const basic_bigint&>(other);
+        }
+        other += *this;
+        return std::move(other);
+    }
+
+    basic_bigint operator+(basic_bigint &&other) && {
+        *this += other;
+        return std::move(*this);
+    }
+
+    basic_bigint operator-(const basic_bigint &other) const & {
+        basic_bigint sum(0,std::max(rank(),other.rank())+1,get_allocator());
+        sum.digits.assign(digits.begin(),digits.end());
+        sum -= other;
+        return sum;
+    }
+
+    basic_bigint operator-(const basic_bigint &other) && {
+        *this -= other;
+        return std::move(*this);
+    }
+
+    basic_bigint operator<<(size_t shift) const & {
+        if(!rank()) {
+            return basic_bigint(get_allocator());
+        }
+
+        size_t new_size = rank()+shift;
+        basic_bigint result(0,new_size,get_allocator());
+        result.digits.resize(new_size);
+        std::copy(digits.begin(),digits.end(),result.digits.begin()+shift);
+        return result;
+    }
+
+    basic_bigint operator<<(size_t shift) && {
+        *this <<= shift;
+        return std::move(*this);
+    }
+
+    basic_bigint operator>>(size_t shift) const & {
+        if(shift >= rank()) {
+            return basic_bigint(get_allocator());
+        }
+
+        size_t new_size = rank() - shift;
+        basic_bigint result(0,new_size,get_allocator());
+        result.digits.resize(new_size);
+        std::copy(digits.begin()+shift,digits.end(),result.digits.begin());
+        return result;
+    }
+
+    basic_bigint operator>>(size_t shift) && {
+        *this >>= shift;
+        return std::move(*this);
+    }
+
+    // In-place limb shifts, reusing the capacity of this value
+    basic_bigint& operator<<=(size_t shift) {
+        if(rank() && shift) {
+            const size_t n = rank();
+            digits.resize(n+shift);
+            std::copy_backward(digits.begin(),digits.begin()+n,digits.end());
+            std::fill(digits.begin(),digits.begin()+shift,0);
+        }
+        return *this;
+    }
+
+    basic_bigint& operator>>=(size_t shift) {
+        if(shift >= rank()) {
+            digits.clear();
+        } else if(shift) {
+            std::copy(digits.begin()+shift,digits.end(),digits.begin());
+            digits.resize(rank()-shift);
+        }
+        return *this;
+    }
+
+    // this += other*radix^k without materializing the shifted value
+    basic_bigint& add_shifted(const basic_bigint &other, size_t k) {
+        if(this == &other) {
+            const basic_bigint copy(other);
+            return add_shifted(copy,k);
+        }
+        if(other.rank()) {
+            const size_t n = std::max(rank(),other.rank()+k)+1;
+            digits.resize(n);
+            add_digits(digits.data()+k,n-k,other.digits.data(),other.rank());
+            erase_leading_zeros();
+        }
+        return *this;
+    }
+
+    // this -= other*radix^k for this >= other*radix^k, without materializing the shifted value
+    basic_bigint& sub_shifted(const basic_bigint &other, size_t k) {
+        if(other.rank()) {
+            sub_digits(digits.data()+k,rank()-k,other.digits.data(),other.rank());
+            erase_leading_zeros();
+        }
+        return *this;
+    }
+
+    // compare(other << k) without materializing the shifted value
+    int compare_shifted(const basic_bigint &other, size_t k) const {
+        if(!other.rank()) {
+            return rank() ? 1 : 0;
+        }
+        if(rank() != other.rank()+k) {
+            return rank() < other.rank()+k ? -1 : 1;
+        }
+        for(size_t i=other.rank();i-- > 0;) {
+            if(digits[i+k] != other.digits[i]) {
+                return digits[i+k] < other.digits[i] ? -1 : 1;
+            }
+        }
+        return std::any_of(digits.begin(),digits.begin()+k,[](digit_t d) { return d != 0; }) ? 1 : 0;
+    }
+
+    // Operand sizes in limbs from which operator* switches to Karatsuba (for squares,
+    // Karatsuba squaring from karatsuba_sqr_threshold), Toom-3, Toom-4 and the NTT.
+    // The Karatsuba thresholds are taken as at least 4: below that the middle
+    // product of m+1 limbs is no smaller than the operands and never bottoms out.
+    static size_t karatsuba_threshold;
+    static size_t karatsuba_sqr_threshold;
+    static size_t toom3_threshold;
+    static size_t toom4_threshold;
+    static size_t ntt_threshold;
+
+    // r[0..n) += a[0..an) for an <= n, returns the carry out of r[n-1]
+    static digit_t add_digits(digit_t *r, size_t n, const digit_t *a, size_t an) {
+        uint64_t extra = 0;
+        size_t i = 0;
+        for(;i < an;++i) {
+            r[i] = split_digit((uint64_t)r[i] + a[i] + extra,extra);
+        }
+        for(;extra && i < n;++i) {
+            r[i] = split_digit((uint64_t)r[i] + extra,extra);
+        }
+        return extra;
+    }
+
+    // r[0..n) -= a[0..an) for an <= n, returns the borrow out of r[n-1]
+    static digit_t sub_digits(digit_t *r, size_t n, const digit_t *a, size_t an) {
+        uint64_t extra = 0;
+        size_t i = 0;
+        for(;i < an;++i) {
+            r[i] = split_digit(radix + r[i] - a[i] - extra,extra);
+            extra = 1 - extra;
+        }
+        for(;extra && i < n;++i) {
+            r[i] = split_digit(radix + r[i] - extra,extra);
+            extra = 1 - extra;
+        }
+        return extra;
+    }
+
+    // r[0..an+bn) = a*b, schoolbook
+    static void mul_basecase(digit_t *r, const digit_t *a, size_t an, const digit_t *b, size_t bn) {
+        std::fill(r,r+an+bn,0);
+        for(size_t i=0;i<an;++i) {
+            if(!a[i]) continue;
+
+            uint64_t extra = 0;
+            for(size_t j=0;j<bn;++j) {
+                r[i+j] = split_digit((uint64_t)a[i]*b[j] + r[i+j] + extra,extra);
+            }
+            r[i+bn] = extra;
+        }
+    }
+
+    // r[0..2n) = a*a, schoolbook computing each cross product a[i]*a[j], i < j, once
+    static void sqr_basecase(digit_t *r, const digit_t *a, size_t n) {
+        std::fill(r,r+2*n,0);
+        for(size_t i=0;i+1<n;++i) {
+            if(!a[i]) continue;
+
+            uint64_t extra = 0;
+            for(size_t j=i+1;j<n;++j) {
+                r[i+j] = split_digit((uint64_t)a[i]*a[j] + r[i+j] + extra,extra);
+            }
+            r[i+n] = extra;
+        }
+
+        add_digits(r,2*n,r,2*n);
+
+        uint64_t extra = 0;
+        for(size_t i=0;i<n;++i) {
+            uint64_t high;
+            const digit_t low = split_digit((uint64_t)a[i]*a[i],high);
+            r[2*i] = split_digit((uint64_t)r[2*i] + low + extra,extra);
+            r[2*i+1] = split_digit(r[2*i+1] + high + extra,extra);
+        }
+    }
+
+    // r[0..an+bn) = a*b for an >= bn > ceil(an/2):
+    // a*b = z2*R^2m + ((a0+a1)(b0+b1) - z0 - z2)*R^m + z0 with z0 = a0*b0, z2 = a1*b1
+    static void mul_karatsuba(digit_t *r, const digit_t *a, size_t an, const digit_t *b, size_t bn) {
+        const size_t m = (an+1)/2;
+        const size_t n = an+bn;
+
+        mul_digits(r,a,m,b,m);
+        mul_digits(r+2*m,a+m,an-m,b+m,bn-m);
+
+        scratch_t sa(m+1), sb(m+1);
+        std::copy(a,a+m,sa.begin());
+        std::copy(b,b+m,sb.begin());
+        add_digits(sa.data(),m+1,a+m,an-m);
+        add_digits(sb.data(),m+1,b+m,bn-m);
+
+        scratch_t z1(2*m+2);
+        mul_digits(z1.data(),sa.data(),m+1,sb.data(),m+1);
+        sub_digits(z1.data(),z1.size(),r,2*m);
+        sub_digits(z1.data(),z1.size(),r+2*m,n-2*m);
+
+        size_t z1n = z1.size();
+        for(;z1n > n-m && !z1[z1n-1];--z1n);
+        add_digits(r+m,n-m,z1.data(),z1n);
+    }
+
+    // r[0..2n) = a*a, Karatsuba with (a0+a1)^2 - a0^2 - a1^2 as the middle term
+    static void sqr_karatsuba(digit_t *r, const digit_t *a, size_t n) {
+        const size_t m = (n+1)/2;
+
+        sqr_digits(r,a,m);
+        sqr_digits(r+2*m,a+m,n-m);
+
+        scratch_t sa(m+1);
+        std::copy(a,a+m,sa.begin());
+        add_digits(sa.data(),m+1,a+m,n-m);
+
+        scratch_t z1(2*m+2);
+        sqr_digits(z1.data(),sa.data(),m+1);
+        sub_digits(z1.data(),z1.size(),r,2*m);
+        sub_digits(z1.data(),z1.size(),r+2*m,2*n-2*m);
+
+        size_t z1n = z1.size();
+        for(;z1n > 2*n-m && !z1[z1n-1];--z1n);
+        add_digits(r+m,2*n-m,z1.data(),z1n);
+    }
+
+    // Signed intermediate of the Toom-Cook evaluation and interpolation steps. Kept in
+    // plain_t, so the temporaries come from the limb pool whatever this type's allocator.
+    struct toom_value {
+        plain_t mag;
+        bool neg;
+
+        toom_value operator+(const toom_value &other) const {
+            if(neg == other.neg) {
+                return toom_value{mag + other.mag,neg};
+            }
+            if(mag >= other.mag) {
+                return toom_value{mag - other.mag,neg && mag != other.mag};
+            }
+            return toom_value{other.mag - mag,other.neg};
+        }
+
+        toom_value operator-(const toom_value &other) const {
+            return *this + toom_value{other.mag,!other.neg && other.mag};
+        }
+
+        toom_value operator*(const toom_value &other) const {
+            plain_t product = (this == &other) ? mag.square() : mag*other.mag;
+            bool product_neg = neg != other.neg && product;
+            return toom_value{std::move(product),product_neg};
+        }
+
+        toom_value operator*(uint32_t n) const {
+            toom_value result(*this);
+            result.mag.mul_add(n,0);
+            return result;
+        }
+
+        // Exact division, the interpolation only ever divides multiples of n
+        toom_value operator/(uint32_t n) const {
+            toom_value result(*this);
+            result.mag.divmod_small(n);
+            return result;
+        }
+    };
+
+    // Values of the polynomial with `parts` coefficients of k limbs taken from a[0..an)
+    // at the points 0, inf, 1, -1, 2, -2, 3 (the first 2*parts-1 of them)
+    static std::vector<toom_value> toom_evaluate(const digit_t *a, size_t an, size_t k, size_t parts) {
+        std::vector<plain_t> piece;
+        for(size_t i=0;i<parts;++i) {
+            plain_t p(0,k);
+            if(i*k < an) {
+                p.digits.assign(a+i*k,a+std::min(an,(i+1)*k));
+                p.erase_leading_zeros();
+            }
+            piece.push_back(std::move(p));
+        }
+
+        std::vector<toom_value> values;
+        values.push_back(toom_value{piece[0],false});
+        values.push_back(toom_value{piece[parts-1],false});
+
+        for(uint32_t t=1;values.size() < 2*parts-1;++t) {
+            toom_value even{plain_t(0,0),false}, odd{plain_t(0,0),false};
+            for(size_t i=parts;i-- > 0;) {
+                plain_t &acc = (i & 1) ? odd.mag : even.mag;
+                acc.mul_add(t*t,0);
+                acc += piece[i];
+            }
+            odd = odd*t;
+
+            values.push_back(even + odd);
+            if(values.size() < 2*parts-1) {
+                values.push_back(even - odd);
+            }
+        }
+
+        return values;
+    }
+
+    // Product coefficients c[0..2*parts-1) from the pointwise products at toom_evaluate() points
+    static std::vector<toom_value> toom_interpolate(const std::vector<toom_value> &v, size_t parts) {
+        std::vector<toom_value> c(2*parts-1);
+        c[0] = v[0];
+        c[2*parts-2] = v[1];
+
+        const toom_value even1 = (v[2] + v[3])/2;
+        const toom_value odd1 = (v[2] - v[3])/2;
+
+        if(parts == 3) {
+            c[2] = even1 - c[0] - c[4];
+            c[3] = ((v[4] - c[0] - c[2]*4 - c[4]*16)/2 - odd1)/3;
+            c[1] = odd1 - c[3];
+            return c;
+        }
+
+        const toom_value even2 = (v[4] + v[5])/2;
+        const toom_value odd2 = (v[4] - v[5])/4;
+
+        const toom_value s1 = even1 - c[0] - c[6];
+        const toom_value s2 = even2 - c[0] - c[6]*64;
+        c[4] = (s2 - s1*4)/12;
+        c[2] = s1 - c[4];
+
+        const toom_value odd3 = (v[6] - c[0] - c[2]*9 - c[4]*81 - c[6]*729)/3;
+        const toom_value d1 = (odd2 - odd1)/3;
+        const toom_value d2 = (odd3 - odd1)/8;
+        c[5] = (d2 - d1)/5;
+        c[3] = d1 - c[5]*5;
+        c[1] = odd1 - c[3] - c[5];
+        return c;
+    }
+
+    // r[0..an+bn) = a*b for an >= bn by Toom-Cook with 3 or 4 parts of ceil(an/parts) limbs.
+    // Squares (a == b) evaluate once and square the values pointwise.
+    static void mul_toom(digit_t *r, const digit_t *a, size_t an, const digit_t *b, size_t bn, size_t parts) {
+        const size_t k = (an+parts-1)/parts;
+        const size_t n = an+bn;
+
+        std::vector<toom_value> va = toom_evaluate(a,an,k,parts);
+        if(a == b && an == bn) {
+            for(size_t i=0;i<va.size();++i) {
+                va[i] = va[i]*va[i];
+            }
+        } else {
+            std::vector<toom_value> vb = toom_evaluate(b,bn,k,parts);
+            for(size_t i=0;i<va.size();++i) {
+                va[i] = va[i]*vb[i];
+            }
+        }
+
+        std::vector<toom_value> c = toom_interpolate(va,parts);
+
+        std::fill(r,r+n,0);
+        for(size_t i=0;i<c.size() && i*k < n;++i) {
+            const plain_t &coeff = c[i].mag;
+            add_digits(r+i*k,n-i*k,coeff.digits.data(),coeff.rank());
+        }
+    }
+
+    // Digits are used as NTT coefficients directly while the convolution terms fit
+    // under the CRT bound. Past that, power-of-two radices are cut into 16-bit pieces.
+    static const size_t ntt_split_bits = 16;
+
+    static bool ntt_direct(size_t an, size_t bn) {
+        return bigint_ntt3::fits(an,bn,radix);
+    }
+
+    static bool ntt_fits(size_t an, size_t bn) {
+        if(ntt_direct(an,bn)) {
+            return true;
+        }
+        const size_t split_an = (an*radix_bits+ntt_split_bits-1)/ntt_split_bits;
+        const size_t split_bn = (bn*radix_bits+ntt_split_bits-1)/ntt_split_bits;
+        return radix_is_pow2 && bigint_ntt3::fits(split_an,split_bn,(uint64_t)1 << ntt_split_bits);
+    }
+
+    static std::vector<uint32_t> ntt_split(const digit_t *a, size_t an) {
+        std::vector<uint32_t> result((an*radix_bits+ntt_split_bits-1)/ntt_split_bits);
+        bigint_repack_bits(a,an,radix_bits,result.data(),result.size(),ntt_split_bits);
+        return result;
+    }
+
+    // r[0..an+bn) = a*b through the three-prime NTT, requires ntt_fits(an,bn)
+    static void mul_ntt(digit_t *r, const digit_t *a, size_t an, const digit_t *b, size_t bn) {
+        const bool square = (a == b && an == bn);
+        if(ntt_direct(an,bn)) {
+            const std::vector<uint32_t> ca(a,a+an);
+            const std::vector<uint32_t> product = square ? bigint_ntt3::multiply<Radix>(ca,ca) :
+                                                           bigint_ntt3::multiply<Radix>(ca,std::vector<uint32_t>(b,b+bn));
+            std::copy(product.begin(),product.end(),r);
+        } else {
+            const std::vector<uint32_t> ca = ntt_split(a,an);
+            const std::vector<uint32_t> product = square ? bigint_ntt3::multiply<(uint64_t)1 << ntt_split_bits>(ca,ca) :
+                                                           bigint_ntt3::multiply<(uint64_t)1 << ntt_split_bits>(ca,ntt_split(b,bn));
+            bigint_repack_bits(product.data(),product.size(),ntt_split_bits,r,an+bn,radix_bits);
+        }
+    }
+
+    // r[0..2n) = a*a, the squaring counterpart of mul_digits()
+    static void sqr_digits(digit_t *r, const digit_t *a, size_t n) {
+        if(n < std::max<size_t>(karatsuba_sqr_threshold,4)) {
+            sqr_basecase(r,a,n);
+        } else if(n >= ntt_threshold && ntt_fits(n,n)) {
+            mul_ntt(r,a,n,a,n);
+        } else if(n >= toom4_threshold) {
+            mul_toom(r,a,n,a,n,4);
+        } else if(n >= toom3_threshold) {
+            mul_toom(r,a,n,a,n,3);
+        } else {
+            sqr_karatsuba(r,a,n);
+        }
+    }
+
+    // r[0..an+bn) = a*b, picks the multiplication algorithm by operand sizes
+    static void mul_digits(digit_t *r, const digit_t *a, size_t an, const digit_t *b, size_t bn) {
+        if(a == b && an == bn) {
+            sqr_digits(r,a,an);
+            return;
+        }
+
+        if(an < bn) {
+            std::swap(a,b);
+            std::swap(an,bn);
+        }
+
+        if(bn < std::max<size_t>(karatsuba_threshold,4)) {
+            mul_basecase(r,a,an,b,bn);
+        } else if(bn >= ntt_threshold && ntt_fits(an,bn)) {
+            mul_ntt(r,a,an,b,bn);
+        } else if(bn >= toom4_threshold && bn > 3*((an+3)/4)) {
+            mul_toom(r,a,an,b,bn,4);
+        } else if(bn >= toom3_threshold && bn > 2*((an+2)/3)) {
+            mul_toom(r,a,an,b,bn,3);
+        } else if(2*bn > an+1) {
+            mul_karatsuba(r,a,an,b,bn);
+        } else {
+            // Unbalanced operands: multiply b by bn-sized slices of a
+            std::fill(r,r+an+bn,0);
+            scratch_t product(2*bn);
+            for(size_t i=0;i<an;i+=bn) {
+                size_t len = std::min(bn,an-i);
+                mul_digits(product.data(),a+i,len,b,bn);
+                add_digits(r+i,an+bn-i,product.data(),len+bn);
+            }
+        }
+    }
+
+    basic_bigint square() const {
+        if(!rank()) {
+            return basic_bigint(get_allocator());
+        }
+
+        basic_bigint total(0,2*rank(),get_allocator());
+        total.digits.resize(2*rank());
+        sqr_digits(total.digits.data(),digits.data(),rank());
+        total.erase_leading_zeros();
+
+        return total;
+    }
+
+    basic_bigint operator*(const basic_bigint &other) const {
+        if(this == &other) {
+            return square();
+        }
+
+        if(!rank() || !other.rank()) {
+            return basic_bigint(get_allocator());
+        }
+
+        basic_bigint total(0,rank()+other.rank(),get_allocator());
+        total.digits.resize(rank()+other.rank());
+        mul_digits(total.digits.data(),digits.data(),rank(),other.digits.data(),other.rank());
+        total.erase_leading_zeros();
+
+        return total;
+    }
+
+    // The product goes through pooled scratch space and back into this value's buffer
+    basic_bigint& operator*=(const basic_bigint &other) {
+        if(!rank() || !other.rank()) {
+            digits.clear();
+        } else if(other.rank() == 1) {
+            mul_add(other.digits[0],0);
+        } else if(rank() == 1) {
+            const digit_t m = digits[0];
+            digits.assign(other.digits.begin(),other.digits.end());
+            mul_add(m,0);
+        } else {
+            scratch_t product(rank()+other.rank());
+            if(this == &other) {
+                sqr_digits(product.data(),digits.data(),rank());
+            } else {
+                mul_digits(product.data(),digits.data(),rank(),other.digits.data(),other.rank());
+            }
+            digits.assign(product.begin(),product.end());
+            erase_leading_zeros();
+        }
+        return *this;
+    }
+
+    uint32_t operator%(uint32_t n) const {
+        const bigint_limb_divisor d(n);
+        uint64_t current = 0;
+        for(auto i=digits.rbegin();i!=digits.rend();++i) {
+            d.divide(current*radix + *i,current);
+        }
+        return current;
+    }
+
+    basic_bigint operator/(uint32_t n) const {
+        basic_bigint total(get_allocator());
+        total.digits.assign(digits.begin(),digits.end());
+        total.divmod_small(n);
+        return total;
+    }
+
+    // Divides in place by n <= 2^32 and returns the remainder
+    uint64_t divmod_small(uint64_t n) {
+        return divmod_small(bigint_limb_divisor(n));
+    }
+
+    uint64_t divmod_small(const bigint_limb_divisor &d) {
+        uint64_t current = 0;
+
+        for(auto i=digits.rbegin();i!=digits.rend();++i) {
+            *i = d.divide(current*radix + *i,current);
+        }
+
+        erase_leading_zeros();
+        return current;
+    }
+
+    // r[0..n) = a[0..n)*m, returns the carry out
+    static digit_t mul_digit(digit_t *r, const digit_t *a, size_t n, digit_t m) {
+        uint64_t extra = 0;
+        for(size_t i=0;i<n;++i) {
+            r[i] = split_digit((uint64_t)a[i]*m + extra,extra);
+        }
+        return extra;
+    }
+
+    // r[0..n) += a[0..n)*m, returns the carry out
+    static digit_t addmul_digit(digit_t *r, const digit_t *a, size_t n, digit_t m) {
+        uint64_t extra = 0;
+        for(size_t i=0;i<n;++i) {
+            r[i] = split_digit((uint64_t)a[i]*m + r[i] + extra,extra);
+        }
+        return extra;
+    }
+
+    // r[0..n) -= a[0..n)*m, returns the borrow out
+    static digit_t submul_digit(digit_t *r, const digit_t *a, size_t n, digit_t m) {
+        uint64_t extra = 0;
+        for(size_t i=0;i<n;++i) {
+            uint64_t high;
+            const digit_t low = split_digit((uint64_t)a[i]*m + extra,high);
+            extra = high + (r[i] < low);
+            r[i] = r[i] < low ? (digit_t)(r[i] + radix - low) : r[i] - low;
+        }
+        return extra;
+    }
+
+    // a[0..n) /= m in place, returns the remainder
+    static digit_t div_digit(digit_t *a, size_t n, digit_t m) {
+        const bigint_limb_divisor d(m);
+        uint64_t current = 0;
+        for(size_t i=n;i-- > 0;) {
+            a[i] = d.divide(current*radix + a[i],current);
+        }
+        return current;
+    }
+
+    // Knuth's Algorithm D (TAOCP 4.3.1): q[0..an-bn] = a/b and r[0..bn) = a%b for
+    // an >= bn >= 2 and b[bn-1] != 0. Both operands are scaled so the top divisor
+    // digit is at least radix/2; then each quotient digit estimated from the top
+    // two remainder digits is at most two too large.
+    static void div_knuth(digit_t *q, digit_t *r, const digit_t *a, size_t an, const digit_t *b, size_t bn) {
+        const digit_t scale = radix/((uint64_t)b[bn-1]+1);
+
+        scratch_t u(an+1), v(bn);
+        u[an] = mul_digit(u.data(),a,an,scale);
+        mul_digit(v.data(),b,bn,scale);
+        div_knuth_scaled(q,u.data(),an,v.data(),bn);
+
+        div_digit(u.data(),bn,scale);
+        std::copy(u.begin(),u.begin()+bn,r);
+    }
+
+    // Main loop of div_knuth() on already scaled operands: u[0..an] holds the
+    // dividend and is left with the scaled remainder in u[0..bn)
+    static void div_knuth_scaled(digit_t *q, digit_t *u, size_t an, const digit_t *v, size_t bn) {
+        const uint64_t v1 = v[bn-1], v2 = v[bn-2];
+        for(size_t j=an-bn+1;j-- > 0;) {
+            digit_t *uj = u+j;
+
+            const uint64_t top = (uint64_t)uj[bn]*radix + uj[bn-1];
+            uint64_t qhat = top / v1;
+            uint64_t rhat = top % v1;
+            while(qhat >= radix || qhat*v2 > rhat*radix + uj[bn-2]) {
+                --qhat;
+                rhat += v1;
+                if(rhat >= radix) break;
+            }
 
+            uint64_t carry = 0, borrow = 0;
+            for(size_t i=0;i<bn;++i) {
+                const digit_t p = split_digit(qhat*v[i] + carry,carry);
+                uj[i] = split_digit(radix + uj[i] - p - borrow,borrow);
+                borrow = 1 - borrow;
+            }
+            const bool negative = (uint64_t)uj[bn] < carry + borrow;
+            uj[bn] -= carry + borrow;
 
-//#define DEBUG_BIGINT
+            if(negative) {
+                --qhat;
+                uj[bn] += add_digits(uj,bn,v,bn);
+            }
 
-struct bigint_t {
-    typedef uint32_t digit_t;
+            q[j] = qhat;
+        }
+    }
 
-    digit_t radix;
-    std::vector<digit_t> digits;
+    // Divisor and quotient size in limbs from which division recurses (Burnikel-Ziegler),
+    // taken as at least 2 so that each recursion splits off some quotient digits
+    static size_t bz_threshold;
 
-    uint32_t guess_divisor(const bigint_t &other) const {
-        if(radix != other.radix) {
-            return guess_divisor(other.convertToRadix(radix));
+    // digits [from,from+len) of a as a value
+    static basic_bigint slice_digits(const basic_bigint &a, size_t from, size_t len) {
+        basic_bigint result(0,len,a.get_allocator());
+        if(from < a.rank()) {
+            result.digits.assign(a.digits.begin()+from,a.digits.begin()+std::min(a.rank(),from+len));
+            result.erase_leading_zeros();
         }
+        return result;
+    }
 
-        if(rank() < 2) {
-            return *digits.rbegin()/(*other.digits.rbegin());
+    // Recursive division, Brent & Zimmermann "Modern Computer Arithmetic" algorithm 1.6,
+    // for b normalized (top digit >= radix/2) and a.rank()-b.rank() <= b.rank().
+    // Splits off k = m/2 quotient digits at a time: the top half comes from dividing
+    // by the top of b only and is fixed up with one product against the rest of b.
+    static void div_recursive(const basic_bigint &a, const basic_bigint &b, basic_bigint &quotient, basic_bigint &remainder) {
+        const size_t n = b.rank();
+        const size_t m = a.rank() > n ? a.rank()-n : 0;
+        if(m < std::max<size_t>(bz_threshold,2)) {
+            divide(a,b,quotient,remainder);
+            return;
         }
 
-        auto u = digits.rbegin();
-        auto v = other.digits.rbegin();
+        const size_t k = m/2;
+        const basic_bigint b1 = b >> k, b0 = slice_digits(b,0,k);
 
-        uint64_t a = (uint64_t)*u*radix + *(u+1);
+        basic_bigint q1, r1;
+        div_recursive(a >> 2*k,b1,q1,r1);
 
-        uint64_t q = 0;
-        if(other.rank() > 1) {
-            uint64_t b = (uint64_t)*v*radix + *(v+1);
-            q = a/b;
+        basic_bigint t = slice_digits(a,0,2*k);
+        t.add_shifted(r1,2*k);
+        basic_bigint d = q1*b0;
+        for(;t.compare_shifted(d,k) < 0;t.add_shifted(b,k)) {
+            q1 -= basic_bigint(1);
         }
+        t.sub_shifted(d,k);
+
+        basic_bigint q0, r0;
+        div_recursive(t >> k,b1,q0,r0);
 
-        if(!q) {
-            q = a/(*v);
+        remainder = slice_digits(t,0,k);
+        remainder.add_shifted(r0,k);
+        d = q0*b0;
+        for(;remainder < d;remainder += b) {
+            q0 -= basic_bigint(1);
         }
-        return q;
-    }
+        remainder -= d;
 
-    void erase_leading_zeros() {
-        auto i = digits.rbegin();
-        for(;i != digits.rend() && !*i;++i);
-        digits.resize(digits.rend() - i);
+        quotient = std::move(q0);
+        quotient.add_shifted(q1,k);
     }
 
-    inline size_t rank() const {
-        return digits.size();
-    }
+    // Divisor size in limbs from which division multiplies by a Newton reciprocal
+    static size_t newton_threshold;
+
+    // Approximation of radix^(2n)/b for normalized b of n digits, good to a few units.
+    // The reciprocal xh of the top h digits of b, shifted by the remaining l digits,
+    // is refined by one Newton step x += x*(radix^(2n) - b*x)/radix^(2n), which
+    // doubles the number of correct digits. Only the l+2 leading digits of both
+    // factors of the correction matter, so the step costs an n*h and an l*l product.
+    static basic_bigint reciprocal(const basic_bigint &b) {
+        const size_t n = b.rank();
+        if(n < newton_threshold || n < 4) {
+            basic_bigint q, r;
+            divide(basic_bigint(1,2*n),b,q,r);
+            return q;
+        }
 
-    bigint_t(uint64_t val, size_t rank, digit_t _radix):radix(_radix) {
-        if(!val) {
-            digits.reserve(rank);
+        const size_t l = n/2, h = n-l;
+        const basic_bigint xh = reciprocal(b >> l);
+        basic_bigint bx = b*xh;
+        bx <<= l;
+        const basic_bigint one(1,2*n);
+
+        const size_t drop = h > l ? h-l-1 : 0;
+        const basic_bigint xt = xh >> drop;
+        const size_t shift = h-drop+2;
+
+        const bool below = bx <= one;
+        basic_bigint e = below ? one - bx : bx - one;
+        e >>= n-2;
+        e *= xt;
+        e >>= shift;
+
+        basic_bigint x = xh;
+        x <<= l;
+        if(below) {
+            x += e;
         } else {
-            digits.reserve(ceil(log(val+1)/log(radix))+rank);
-            while(rank--) {
-                digits.push_back(0);
-            }
-            for(;val;val /= radix) {
-                digits.push_back(val % radix);
-            }
+            x -= e;
+            x -= basic_bigint(1);
+        }
+        return x;
+    }
+
+    // Barrett division for normalized b of n digits, a < b*radix^n and
+    // inv = reciprocal(b): the estimate from the top n+1 digits of a is within
+    // a few units of the true quotient
+    static void div_reciprocal(const basic_bigint &a, const basic_bigint &b, const basic_bigint &inv, basic_bigint &quotient, basic_bigint &remainder) {
+        const size_t n = b.rank();
+        quotient = a >> (n-1);
+        quotient *= inv;
+        quotient >>= n+1;
+
+        basic_bigint qb = quotient*b;
+        for(;qb > a;qb -= b) {
+            quotient -= basic_bigint(1);
+        }
+        for(remainder = a - qb;remainder >= b;remainder -= b) {
+            quotient += basic_bigint(1);
         }
     }
 
-    bigint_t(uint64_t val):bigint_t(val,0,std::numeric_limits<digit_t>::max()) {
+    // Normalizes the operands and divides a block of b.rank() digits at a time,
+    // each block division being balanced for div_recursive() or div_reciprocal()
+    static void divide_large(const basic_bigint &a, const basic_bigint &b, basic_bigint &quotient, basic_bigint &remainder) {
+        divide_large(a,b,quotient,remainder,std::integral_constant<bool,plain_alloc>());
+    }
 
+    // With a caller's allocator the recursive and Newton steps run on plain_t, so
+    // their temporaries come from the limb pool and only the results use the allocator
+    static void divide_large(const basic_bigint &a, const basic_bigint &b, basic_bigint &quotient, basic_bigint &remainder, std::false_type) {
+        plain_t q, r;
+        plain_t::divide_large(plain_t(a),plain_t(b),q,r);
+        quotient.assign_plain(std::move(q));
+        remainder.assign_plain(std::move(r));
     }
 
-    bigint_t(const std::string &s,digit_t _radix):radix(std::numeric_limits<digit_t>::max()) {
-        bigint_t tmp(0,s.size(),_radix);
+    static void divide_large(const basic_bigint &a, const basic_bigint &b, basic_bigint &quotient, basic_bigint &remainder, std::true_type) {
+        const digit_t scale = radix/((uint64_t)b.digits.back()+1);
+        basic_bigint u(a), v(b);
+        u.mul_add(scale,0);
+        v.mul_add(scale,0);
+
+        const basic_bigint inv = v.rank() >= newton_threshold ? reciprocal(v) : basic_bigint(0,0);
+        divide_blocks(u,v,inv,quotient,remainder);
+
+        div_digit(remainder.digits.data(),remainder.rank(),scale);
+        remainder.erase_leading_zeros();
+    }
 
-        digit_t val = 0;
-        for(auto i=s.rbegin();i!=s.rend();++i) {
-            if(isdigit(*i)) {
-                val = *i - '0';
-            } else if(isupper(*i)) {
-                val = *i - 'A' + 10;
-            } else if(islower(*i)) {
-                val = *i - 'a' + 36;
+    // Block loop of divide_large() on scaled operands; inv is reciprocal(v), or
+    // zero to use div_recursive(). The remainder is left scaled.
+    static void divide_blocks(const basic_bigint &u, const basic_bigint &v, const basic_bigint &inv, basic_bigint &quotient, basic_bigint &remainder) {
+        const size_t n = v.rank();
+        const size_t blocks = (u.rank()+n-1)/n;
+        const bool newton = inv.rank() != 0;
+
+        quotient.digits.assign(blocks*n,0);
+        remainder = basic_bigint(0,0);
+        for(size_t i=blocks;i-- > 0;) {
+            basic_bigint current = slice_digits(u,i*n,n);
+            current.add_shifted(remainder,n);
+            basic_bigint q;
+            if(newton) {
+                div_reciprocal(current,v,inv,q,remainder);
             } else {
-                break;
+                div_recursive(current,v,q,remainder);
             }
-
-            if(val >= _radix) break;
-            tmp.digits.push_back(val);
+            std::copy(q.digits.begin(),q.digits.end(),quotient.digits.begin()+i*n);
         }
 
-        //digits.reserve(ceil(s.size()/(log(radix)/log(_radix))));
-        for(;tmp;tmp = tmp/radix) {
-            digits.push_back(tmp%radix);
-        }
+        quotient.erase_leading_zeros();
     }
 
-    int compare(const bigint_t &other) const {
-
-        if(radix != other.radix) {
-            return compare(other.convertToRadix(radix));
+    // quotient = a/b, remainder = a%b for b != 0
+    static void divide(const basic_bigint &a, const basic_bigint &b, basic_bigint &quotient, basic_bigint &remainder) {
+        if(a < b) {
+            quotient.digits.clear();
+            remainder = a;
+            return;
         }
 
-        if(rank() == other.rank()) {
-            auto a = digits.rbegin();
-            auto b = other.digits.rbegin();
-            for(;a != digits.rend() && *a == *b;++a,++b);
-
-            if(a == digits.rend()) {
-                return 0;
-            }
+        if(b.rank() == 1) {
+            quotient = a;
+            remainder = basic_bigint(div_digit(quotient.digits.data(),quotient.rank(),b.digits[0]),0,remainder.get_allocator());
+            quotient.erase_leading_zeros();
+            return;
+        }
 
-            return *a - *b;
-        } else {
-            return rank() - other.rank();
+        const size_t bz = std::max<size_t>(bz_threshold,2);
+        if(b.rank() >= bz && a.rank()-b.rank() >= bz) {
+            divide_large(a,b,quotient,remainder);
+            return;
         }
+
+        quotient.digits.assign(a.rank()-b.rank()+1,0);
+        remainder.digits.assign(b.rank(),0);
+        div_knuth(quotient.digits.data(),remainder.digits.data(),a.digits.data(),a.rank(),b.digits.data(),b.rank());
+        quotient.erase_leading_zeros();
+        remainder.erase_leading_zeros();
     }
 
-    inline bool operator<(const bigint_t &other) const {
-        return compare(other) < 0;
+    struct divmod_result {
+        basic_bigint quotient;
+        basic_bigint remainder;
+    };
+
+    // Quotient and remainder from a single division pass
+    divmod_result divmod(const basic_bigint &other) const {
+        divmod_result result{basic_bigint(get_allocator()),basic_bigint(get_allocator())};
+        divide(*this,other,result.quotient,result.remainder);
+        return result;
     }
 
-    inline bool operator>(const bigint_t &other) const {
-        return compare(other) > 0;
+    basic_bigint operator/(const basic_bigint &other) const {
+        basic_bigint quotient(get_allocator()), remainder(get_allocator());
+        divide(*this,other,quotient,remainder);
+        return quotient;
     }
 
-    inline bool operator<=(const bigint_t &other) const {
-        return compare(other) <= 0;
+    basic_bigint operator%(const basic_bigint &other) const {
+        basic_bigint quotient(get_allocator()), remainder(get_allocator());
+        divide(*this,other,quotient,remainder);
+        return remainder;
     }
 
-    inline bool operator>=(const bigint_t &other) const {
-        return compare(other) >= 0;
+    basic_bigint& operator/=(const basic_bigint &other) {
+        basic_bigint quotient(get_allocator()), remainder(get_allocator());
+        divide(*this,other,quotient,remainder);
+        digits.swap(quotient.digits);
+        return *this;
     }
 
-    inline bool operator==(const bigint_t &other) const {
-        return compare(other) == 0;
+    basic_bigint& operator%=(const basic_bigint &other) {
+        basic_bigint quotient(get_allocator()), remainder(get_allocator());
+        divide(*this,other,quotient,remainder);
+        digits.swap(remainder.digits);
+        return *this;
     }
 
-    inline bool operator!=(const bigint_t &other) const {
-        return compare(other) != 0;
+    std::string toString(radix_t view_radix=10) const {
+        std::string result(size_in_base(view_radix),'\0');
+        const to_chars_result written = to_chars(&result[0],&result[0]+result.size(),view_radix);
+        result.resize(written.ptr - result.data());
+        return result;
     }
 
-    bigint_t& operator+=(const bigint_t &other) {
-        if(radix != other.radix) {
-            return operator+=(other.convertToRadix(radix));
+    typedef bigint_to_chars_result to_chars_result;
+
+    // Upper bound of the number of characters to_chars() writes for view_radix
+    size_t size_in_base(radix_t view_radix=10) const {
+        const size_t digit_len = view_radix <= 62 ? 1 : (sizeof(uint32_t)*2+2);
+        if(!rank()) {
+            return digit_len;
         }
+        if(view_radix == radix) {
+            return rank()*digit_len;
+        }
+        return ((size_t)ceil(rank()*log2((double)radix)/log2((double)view_radix))+1)*digit_len;
+    }
 
-        if(rank() < other.rank()) {
-            digits.reserve(other.rank()+1);
-            digits.resize(other.rank());
+    // Writes the value in view_radix to [first,last) without a terminator. Radices
+    // up to 62 use one character per digit, larger ones print each digit as
+    // [XXXXXXXX] in hex. Like std::to_chars, returns the end of the output, or
+    // last and std::errc::value_too_large when the range is too small.
+    to_chars_result to_chars(char *first, char *last, radix_t view_radix=10) const {
+        return to_chars(first,last,view_radix,std::integral_constant<bool,plain_alloc>());
+    }
+
+    to_chars_result to_chars(char *first, char *last, radix_t view_radix, std::false_type) const {
+        return plain_t(*this).to_chars(first,last,view_radix);
+    }
+
+    to_chars_result to_chars(char *first, char *last, radix_t view_radix, std::true_type) const {
+        static const char *single_digits = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+        const to_chars_result too_large = {last,std::errc::value_too_large};
+        if(!rank()) {
+            if(first == last) return too_large;
+            *first = '0';
+            return {first+1,std::errc()};
         }
 
-        auto a = digits.begin();
-        auto b = other.digits.begin();
+        if(radix_is_pow2 && is_pow2(view_radix) && view_radix != radix && view_radix <= 62) {
+            // every character is a fixed group of bits, written from the lowest
+            const size_t bits = bigint_log2(view_radix);
+            const size_t len = ((rank()-1)*radix_bits + bigint_log2(digits.back()) + bits)/bits;
+            if(len > (size_t)(last-first)) return too_large;
+
+            char *out = first + len;
+            uint64_t acc = 0;
+            size_t acc_bits = 0;
+            for(auto limb: digits) {
+                acc |= (uint64_t)limb << acc_bits;
+                for(acc_bits += radix_bits;acc_bits >= bits && out != first;acc_bits -= bits,acc >>= bits) {
+                    *--out = single_digits[acc & (view_radix-1)];
+                }
+            }
+            if(out != first) {
+                *--out = single_digits[acc];
+            }
 
-        digit_t extra = 0;
-        for(;a != digits.end() && b != other.digits.end();++a,++b) {
-            uint64_t val = (uint64_t)*a + *b + extra;
-            *a = val % radix;
-            extra = val / radix;
+            return {first+len,std::errc()};
         }
 
-        for(;extra && a != digits.end();++a) {
-            uint64_t val = (uint64_t)*a + extra;
-            *a = val % radix;
-            extra = val / radix;
+        if(view_radix != radix && view_radix <= 62) {
+            power_tree &tree = shared_power_tree(view_radix);
+            const size_t per_chunk = tree.per_chunk;
+
+            chunks_t chunks;
+            chunks.reserve(ceil(rank()*log(radix)/log(tree.base))+1);
+            to_chunks(*this,tree,0,chunks);
+
+            size_t top_len = 0;
+            for(uint64_t top=chunks.back();top;top /= view_radix,++top_len);
+            const size_t len = (chunks.size()-1)*per_chunk + top_len;
+            if(len > (size_t)(last-first)) return too_large;
+
+            char *out = first + len;
+            const bigint_limb_divisor digit(view_radix);
+            for(size_t j=0;j<chunks.size();++j) {
+                const size_t n = j+1 < chunks.size() ? per_chunk : top_len;
+                out -= n;
+                if(view_radix == 10 && n == 9) {
+                    bigint_format_decimal9(chunks[j],out);
+                    continue;
+                }
+                uint64_t value = chunks[j], rem;
+                for(size_t i=n;i-- > 0;) {
+                    value = digit.divide(value,rem);
+                    out[i] = single_digits[rem];
+                }
+            }
+
+            return {first+len,std::errc()};
         }
 
-        if(extra && a == digits.end()) {
-            digits.push_back(extra);
+        const std::vector<uint32_t> view = toDigits(view_radix);
+        const size_t digit_len = view_radix <= 62 ? 1 : (sizeof(uint32_t)*2+2);
+        if(view.size()*digit_len > (size_t)(last-first)) return too_large;
+
+        char* out = first + view.size()*digit_len;
+        for(auto n: view) {
+            if(digit_len == 1) {
+                *--out = single_digits[n];
+            } else {
+                *--out = ']';
+                for(size_t shift=0;shift < sizeof(uint32_t)*8;shift += 4) {
+                    *--out = single_digits[(n >> shift) & 0xF];
+                }
+                *--out = '[';
+            }
         }
 
-        return *this;
+        return {first+view.size()*digit_len,std::errc()};
     }
 
-    bigint_t& operator-=(const bigint_t &other) {
-        if(radix != other.radix) {
-            return operator-=(other.convertToRadix(radix));
-        }
+    explicit operator bool() const {
+        return rank() != 0;
+    }
 
-        if(rank() < other.rank()) {
-            digits.reserve(other.rank()+1);
-        }
+    template<uint64_t NewRadix>
+    basic_bigint<NewRadix,Limb,Alloc> convertToRadix() const {
+        return basic_bigint<NewRadix,Limb,Alloc>(*this,get_allocator());
+    }
 
-        auto a = digits.begin();
-        auto b = other.digits.begin();
+    // Limb count from which radix conversion splits the number through a power tree,
+    // taken as at least 2 so that every split makes progress
+    static size_t radix_dc_threshold;
 
-        digit_t extra = 0;
-        for(;a != digits.end() && b != other.digits.end();++a,++b) {
-            uint64_t val = (uint64_t)radix + *a - *b - extra;
-            *a = val % radix;
-            extra = 1 - val / radix;
-        }
+    static bool is_pow2(uint64_t r) {
+        return (r & (r-1)) == 0;
+    }
+
+    // Largest power of r that fits into 32 bits; per_chunk is its exponent
+    static uint64_t radix_chunk(uint64_t r, size_t &per_chunk) {
+        uint64_t chunk = r;
+        for(per_chunk=1;r > 1 && chunk <= ((uint64_t)1 << 32)/r;chunk *= r,++per_chunk);
+        return chunk;
+    }
+
+    // Powers base^(2^i) in this radix of base = r^per_chunk, the largest power of
+    // the digit radix r that fits into 32 bits, with divisors prepared for each of
+    // them. Levels are grown on demand under a lock; deques keep references to
+    // built levels valid while other threads add new ones.
+    struct power_tree {
+        size_t per_chunk;
+        uint64_t base;
+        std::deque<basic_bigint> powers;
+        std::deque<basic_bigint_divisor<Radix,Limb,Alloc>> divisors;
+        std::mutex lock;
+
+        explicit power_tree(uint64_t r):base(radix_chunk(r,per_chunk)),powers(1,basic_bigint(base)) {
 
-        for(;extra && a != digits.end();++a) {
-            uint64_t val = (uint64_t)radix + *a - extra;
-            *a = val % radix;
-            extra = 1 - val / radix;
         }
 
-        for(;b != other.digits.end();++b) {
-            uint64_t val = (uint64_t)radix - *b - extra;
-            digits.push_back(val % radix);
-            extra = 1 - val / radix;
+        const basic_bigint& power(size_t i) {
+            std::lock_guard<std::mutex> guard(lock);
+            while(powers.size() <= i) {
+                powers.push_back(powers.back().square());
+            }
+            return powers[i];
         }
 
-        if(extra && a == digits.end()) {
-            digits.push_back(radix-1);
+        const basic_bigint_divisor<Radix,Limb,Alloc>& divisor(size_t i) {
+            power(i);
+            std::lock_guard<std::mutex> guard(lock);
+            while(divisors.size() <= i) {
+                divisors.emplace_back(powers[divisors.size()]);
+            }
+            return divisors[i];
         }
+    };
 
-        erase_leading_zeros();
+    // Process-wide power tree for digit radix r, shared by all conversions
+    static power_tree& shared_power_tree(uint64_t r) {
+        static std::mutex lock;
+        static std::map<uint64_t,std::unique_ptr<power_tree>> trees;
 
-        return *this;
+        std::lock_guard<std::mutex> guard(lock);
+        std::unique_ptr<power_tree> &tree = trees[r];
+        if(!tree) {
+            tree.reset(new power_tree(r));
+        }
+        return *tree;
     }
 
-    bigint_t operator+(const bigint_t &other) const {
-        if(radix != other.radix) {
-            return operator+(other.convertToRadix(radix));
+    // this = d[0..n) read as little-endian digits in src_radix <= 2^32
+    template<typename T>
+    void assign_digits(const T *d, size_t n, uint64_t src_radix) {
+        if(radix_is_pow2 && is_pow2(src_radix)) {
+            const size_t bits = bigint_log2(src_radix);
+            digits.resize((n*bits+radix_bits-1)/radix_bits);
+            bigint_repack_bits(d,n,bits,digits.data(),rank(),radix_bits);
+            erase_leading_zeros();
+            return;
         }
 
-        bigint_t sum(0,std::max(rank(),other.rank())+1,radix);
-        sum.digits.assign(digits.begin(),digits.end());
-        sum += other;
-        return sum;
+        assign_digits(d,n,src_radix,std::integral_constant<bool,plain_alloc>());
+    }
+
+    template<typename T>
+    void assign_digits(const T *d, size_t n, uint64_t src_radix, std::false_type) {
+        plain_t value;
+        value.assign_digits(d,n,src_radix);
+        digits.assign(value.digits.begin(),value.digits.end());
     }
 
-    bigint_t operator-(const bigint_t &other) const {
-        if(radix != other.radix) {
-            return operator-(other.convertToRadix(radix));
+    template<typename T>
+    void assign_digits(const T *d, size_t n, uint64_t src_radix, std::true_type) {
+        size_t per_chunk;
+        const uint64_t base = radix_chunk(src_radix,per_chunk);
+
+        chunks_t chunks((n+per_chunk-1)/per_chunk);
+        for(size_t j=0;j<chunks.size();++j) {
+            uint64_t word = 0;
+            for(size_t k=std::min(n,(j+1)*per_chunk);k-- > j*per_chunk;) {
+                word = word*src_radix + d[k];
+            }
+            chunks[j] = word;
         }
 
-        bigint_t sum(0,std::max(rank(),other.rank())+1,radix);
-        sum.digits.assign(digits.begin(),digits.end());
-        sum -= other;
-        return sum;
+        *this = from_chunks(chunks.data(),chunks.size(),base,src_radix);
     }
 
-    bigint_t operator<<(size_t shift) const {
-        size_t new_size = rank()+shift;
-        bigint_t result(0,new_size,radix);
-        result.digits.resize(new_size);
-        std::copy(digits.begin(),digits.end(),result.digits.begin()+shift);
+    // Value of c[0..n) read as little-endian digits in base = radix_chunk(r). Long
+    // inputs are split in halves, high*base^(2^level) + low, with the powers from
+    // the shared tree for r.
+    static basic_bigint from_chunks(const uint32_t *c, size_t n, uint64_t base, uint64_t r) {
+        if(n*log(base) < std::max<size_t>(radix_dc_threshold,2)*log(radix) || n <= 1) {
+            basic_bigint result;
+            result.digits.reserve(ceil(n*log(base)/log(radix))+1);
+            for(size_t i=n;i-- > 0;) {
+                result.mul_add(base,c[i]);
+            }
+            result.erase_leading_zeros();
+            return result;
+        }
+
+        size_t level = 0;
+        for(;((size_t)2 << level) < n;++level);
+        const size_t m = (size_t)1 << level;
+
+        basic_bigint result = from_chunks(c+m,n-m,base,r);
+        if(result.rank()) {
+            result = result*shared_power_tree(r).power(level);
+        }
+        result += from_chunks(c,m,base,r);
         return result;
     }
 
-    bigint_t operator>>(size_t shift) const {
-        if(shift >= rank()) {
-            return bigint_t(0,0,radix);
+    // Digits of the value in an arbitrary view_radix <= 2^32, least significant first
+    std::vector<uint32_t> toDigits(radix_t view_radix) const {
+        std::vector<uint32_t> result;
+        if(view_radix == radix) {
+            result.assign(digits.begin(),digits.end());
+            return result;
         }
 
-        size_t new_size = rank() - shift;
-        bigint_t result(0,new_size,radix);
-        result.digits.resize(new_size);
-        std::copy(digits.begin()+shift,digits.end(),result.digits.begin());
-        return result;
+        return toDigits(view_radix,std::integral_constant<bool,plain_alloc>());
+    }
+
+    std::vector<uint32_t> toDigits(radix_t view_radix, std::false_type) const {
+        return plain_t(*this).toDigits(view_radix);
     }
 
-    bigint_t operator*(const bigint_t &other) const {
-        if(radix != other.radix) {
-            return operator*(other.convertToRadix(radix));
+    std::vector<uint32_t> toDigits(radix_t view_radix, std::true_type) const {
+        std::vector<uint32_t> result;
+        if(radix_is_pow2 && is_pow2(view_radix)) {
+            const size_t bits = bigint_log2(view_radix);
+            result.resize((rank()*radix_bits+bits-1)/bits);
+            bigint_repack_bits(digits.data(),rank(),radix_bits,result.data(),result.size(),bits);
+            for(;!result.empty() && !result.back();result.pop_back());
+            return result;
+        }
+
+        power_tree &tree = shared_power_tree(view_radix);
+        chunks_t chunks;
+        chunks.reserve(ceil(rank()*log(radix)/log(tree.base))+1);
+        to_chunks(*this,tree,0,chunks);
+
+        // split each chunk into per_chunk digits with word arithmetic
+        result.reserve(chunks.size()*tree.per_chunk);
+        const bigint_limb_divisor digit(view_radix);
+        for(auto n: chunks) {
+            uint64_t value = n, rem;
+            for(size_t i=0;i<tree.per_chunk;++i) {
+                value = digit.divide(value,rem);
+                result.push_back(rem);
+            }
         }
 
-        bigint_t total(0,rank()+other.rank()+1,radix);
+        for(;!result.empty() && !result.back();result.pop_back());
+        return result;
+    }
 
-        for(auto a=digits.begin();a!=digits.end();++a) {
-            for(auto b=other.digits.begin();b!=other.digits.end();++b) {
-                size_t rank = (a - digits.begin()) + (b - other.digits.begin());
-                uint64_t p = (uint64_t)*a * *b;
-                bigint_t product(p,rank,radix);
-                total += product;
+    // Appends the digits of x in base tree.base to out, padded with zeros to pad
+    // digits. Long values are split by the largest tree power about half their size.
+    static void to_chunks(const basic_bigint &x, power_tree &tree, size_t pad, chunks_t &out) {
+        const size_t start = out.size();
+
+        const size_t threshold = std::max<size_t>(radix_dc_threshold,2);
+        size_t level = 0;
+        if(x.rank() >= threshold) {
+            for(;4*tree.power(level).rank() <= x.rank()+3;++level);
+            // a power exactly twice the previous one can be just over half of x
+            if(level && 2*tree.power(level).rank() > x.rank()+1) {
+                --level;
             }
         }
 
-        return total;
+        // only values of a couple of limbs are left when even the base does not fit
+        if(x.rank() < threshold || 2*tree.power(level).rank() > x.rank()+1) {
+            const bigint_limb_divisor d(tree.base);
+            for(basic_bigint current=x;current;) {
+                out.push_back(current.divmod_small(d));
+            }
+        } else {
+            const size_t m = (size_t)1 << level;
+            auto qr = tree.divisor(level).divmod(x);
+            to_chunks(qr.remainder,tree,m,out);
+            to_chunks(qr.quotient,tree,pad ? pad-m : 0,out);
+        }
+
+        if(pad) {
+            out.resize(start+pad,0);
+        }
     }
+};
 
-    uint32_t operator%(uint32_t n) const {
-        uint64_t total = 0;
-        uint64_t base = 1;
-        for(auto i: digits) {
-            total += (i % n) * base;
-            total %= n;
-            base = (base*radix) % n;
+template<uint64_t Radix, typename Limb, typename Alloc> const size_t basic_bigint<Radix,Limb,Alloc>::digit_bits;
+template<uint64_t Radix, typename Limb, typename Alloc> const uint64_t basic_bigint<Radix,Limb,Alloc>::native_radix;
+template<uint64_t Radix, typename Limb, typename Alloc> const uint64_t basic_bigint<Radix,Limb,Alloc>::radix;
+template<uint64_t Radix, typename Limb, typename Alloc> const bool basic_bigint<Radix,Limb,Alloc>::radix_is_pow2;
+template<uint64_t Radix, typename Limb, typename Alloc> const size_t basic_bigint<Radix,Limb,Alloc>::radix_bits;
+template<uint64_t Radix, typename Limb, typename Alloc> const size_t basic_bigint<Radix,Limb,Alloc>::ntt_split_bits;
+template<uint64_t Radix, typename Limb, typename Alloc> const size_t basic_bigint<Radix,Limb,Alloc>::inline_limbs;
+template<uint64_t Radix, typename Limb, typename Alloc> const bool basic_bigint<Radix,Limb,Alloc>::plain_alloc;
+template<uint64_t Radix, typename Limb, typename Alloc> size_t basic_bigint<Radix,Limb,Alloc>::karatsuba_threshold = 32;
+template<uint64_t Radix, typename Limb, typename Alloc> size_t basic_bigint<Radix,Limb,Alloc>::karatsuba_sqr_threshold = 48;
+template<uint64_t Radix, typename Limb, typename Alloc> size_t basic_bigint<Radix,Limb,Alloc>::toom3_threshold = 512;
+template<uint64_t Radix, typename Limb, typename Alloc> size_t basic_bigint<Radix,Limb,Alloc>::toom4_threshold = 1536;
+template<uint64_t Radix, typename Limb, typename Alloc> size_t basic_bigint<Radix,Limb,Alloc>::ntt_threshold = 3072;
+template<uint64_t Radix, typename Limb, typename Alloc> size_t basic_bigint<Radix,Limb,Alloc>::bz_threshold = 64;
+template<uint64_t Radix, typename Limb, typename Alloc> size_t basic_bigint<Radix,Limb,Alloc>::newton_threshold = 4096;
+template<uint64_t Radix, typename Limb, typename Alloc> size_t basic_bigint<Radix,Limb,Alloc>::radix_dc_threshold = 32;
+
+// Divisor prepared once for repeated division: keeps the scaled divisor, the
+// scale factor and, for huge divisors, the Newton reciprocal, so each division
+// only has to scale the dividend
+template<uint64_t Radix, typename Limb, typename Alloc>
+struct basic_bigint_divisor {
+    typedef basic_bigint<Radix,Limb,Alloc> value_t;
+    typedef typename value_t::digit_t digit_t;
+    typedef typename value_t::divmod_result divmod_result;
+    // The division steps run on plain_t, whose temporaries come from the limb pool
+    typedef typename value_t::plain_t kernel_t;
+
+    value_t divisor;
+    kernel_t normalized;
+    kernel_t inverse;
+    digit_t scale;
+    bigint_limb_divisor limb;
+
+    explicit basic_bigint_divisor(const value_t &b):divisor(b),normalized(b),
+        scale(value_t::radix/((uint64_t)b.digits.back()+1)),limb(b.rank() == 1 ? b.digits[0] : 1) {
+        normalized.mul_add(scale,0);
+        if(normalized.rank() >= kernel_t::newton_threshold) {
+            inverse = kernel_t::reciprocal(normalized);
         }
-        return total;
     }
 
-    bigint_t operator/(uint32_t n) const {
-        bigint_t total(0,rank(),radix);
+    divmod_result divmod(const value_t &a) const {
+        divmod_result result{value_t(a.get_allocator()),value_t(a.get_allocator())};
+        value_t &q = result.quotient, &r = result.remainder;
+        const size_t n = divisor.rank();
 
-        uint64_t current = 0;
+        if(a < divisor) {
+            r = a;
+            return result;
+        }
 
-        for(auto i=digits.rbegin();i!=digits.rend();++i) {
-            current = current*radix + *i;
-            if(current >= n) {
-                size_t rank = digits.rend() - i - 1;
-                total += bigint_t(current/n,rank,radix);
-                current %= n;
-            }
+        if(n == 1) {
+            q = a;
+            r = value_t(q.divmod_small(limb),0,a.get_allocator());
+            return result;
         }
 
-        return total;
+        kernel_t u(a), kq, kr;
+        u.mul_add(scale,0);
+        const size_t bz = std::max<size_t>(kernel_t::bz_threshold,2);
+        if(n >= bz && a.rank()-n >= bz) {
+            kernel_t::divide_blocks(u,normalized,inverse,kq,kr);
+        } else {
+            u.digits.resize(a.rank()+1);
+            kq.digits.assign(a.rank()-n+1,0);
+            kernel_t::div_knuth_scaled(kq.digits.data(),u.digits.data(),a.rank(),normalized.digits.data(),n);
+            u.digits.resize(n);
+            kr.digits.swap(u.digits);
+            kq.erase_leading_zeros();
+        }
+
+        kernel_t::div_digit(kr.digits.data(),kr.rank(),scale);
+        kr.erase_leading_zeros();
+        q.assign_plain(std::move(kq));
+        r.assign_plain(std::move(kr));
+        return result;
     }
 
-    bigint_t operator/(const bigint_t &other) const {
-        if(radix != other.radix) {
-            return operator/(other.convertToRadix(radix));
-        }
+    value_t div(const value_t &a) const {
+        return divmod(a).quotient;
+    }
 
-        bigint_t total(0,rank(),radix);
-        bigint_t current(*this);
+    value_t mod(const value_t &a) const {
+        return divmod(a).remainder;
+    }
+};
 
-        for(int i=0;current.compare(other) > 0;++i) {
-            auto q = current.guess_divisor(other);
-            bigint_t sub = other*bigint_t(q,0,radix);
-            int rank_diff = std::max(0,(int)current.rank() - (int)sub.rank());
-            bigint_t head = current >> rank_diff;
-#ifdef DEBUG_BIGINT
-            fprintf(stderr,"1cur[%s] other[%s] q[%u] rank_diff[%d]\nhead[%s]\n sub[%s]\n",
-                    current.toString(radix).c_str(),
-                    other.toString(radix).c_str(),
-                    q,
-                    rank_diff,
-                    head.toString(radix).c_str(),
-                    sub.toString(radix).c_str());
-#endif
-            for(;q && sub > head;--q) {
-                sub -= other;
-            }
-#ifdef DEBUG_BIGINT
-            fprintf(stderr,"2cur[%s] other[%s] q[%u] rank_diff[%d]\nhead[%s]\n sub[%s]\n",
-                    current.toString(radix).c_str(),
-                    other.toString(radix).c_str(),
-                    q,
-                    rank_diff,
-                    head.toString(radix).c_str(),
-                    sub.toString(radix).c_str());
-#endif
-            if(!q && rank_diff) {
-                q = radix - 1;
-                sub = other*bigint_t(q,0,radix);
-                rank_diff = std::max(0,(int)current.rank() - (int)sub.rank());
-
-#ifdef DEBUG_BIGINT
-                bigint_t head = current >> rank_diff;
-
-                fprintf(stderr,"3cur[%s] other[%s] q[%u] rank_diff[%d]\nhead[%s]\n sub[%s]\n",
-                        current.toString(radix).c_str(),
-                        other.toString(radix).c_str(),
-                        q,
-                        rank_diff,
-                        head.toString(radix).c_str(),
-                        sub.toString(radix).c_str());
-#endif
+template<uint64_t Radix, typename Limb, typename Alloc>
+typename basic_bigint<Radix,Limb,Alloc>::divmod_result divmod(const basic_bigint<Radix,Limb,Alloc> &a, const basic_bigint<Radix,Limb,Alloc> &b) {
+    return a.divmod(b);
+}
+
+// Lazy arithmetic on values of V. a.lazy() + b.lazy()*c - d*3 builds a tree of
+// references instead of a value per operator; assigning it to a V, or adding or
+// subtracting it from one, flattens the tree into signed terms and accumulates
+// them into the destination's limbs in one pass. Products of two values and
+// values scaled by a limb are multiplied straight into the sum. Operands are
+// held by reference, so an expression must be evaluated within the statement
+// that builds it. Like the eager operators, the result must not be negative.
+template<typename V>
+struct bigint_expr_terms {
+    typedef typename V::digit_t digit_t;
+
+    // a*b*m, with b == nullptr for a single factor
+    struct term {
+        const V *a;
+        const V *b;
+        digit_t m;
+        bool negative;
+
+        size_t rank() const {
+            if(!a->rank() || (b && !b->rank())) {
+                return 0;
             }
+            return a->rank() + (b ? b->rank() : 0) + (m != 1);
+        }
+    };
+
+    bigint_limbs<term,8,bigint_pool_allocator<term>> list;
+    std::forward_list<V,bigint_pool_allocator<V>> temporaries;
 
-            current -= sub << rank_diff;
+    void add(const V *a, const V *b, digit_t m, bool negative) {
+        list.push_back(term{a,b,m,negative});
+    }
+
+    // Keeps a value computed from a subexpression alive until evaluation ends
+    const V& hold(V &&value) {
+        temporaries.push_front(std::move(value));
+        return temporaries.front();
+    }
 
-            total += bigint_t(q,rank_diff,radix);
+    bool refers_to(const V *x) const {
+        for(const term &t: list) {
+            if(t.a == x || t.b == x) {
+                return true;
+            }
         }
+        return false;
+    }
 
-        int cmp = current.compare(other);
-        if(cmp == 0) {
-            return total + bigint_t(1,0,radix);
+    static void add_term(digit_t *r, size_t n, const term &t) {
+        const digit_t *a = t.a->digits.data(), *b = t.b ? t.b->digits.data() : nullptr;
+        size_t an = t.a->rank(), bn = t.b ? t.b->rank() : 0;
+        if(!b) {
+            if(t.m == 1) {
+                V::add_digits(r,n,a,an);
+            } else {
+                const digit_t carry = V::addmul_digit(r,a,an,t.m);
+                V::add_digits(r+an,n-an,&carry,1);
+            }
+        } else if(std::min(an,bn) < V::karatsuba_threshold) {
+            if(an < bn) {
+                std::swap(a,b);
+                std::swap(an,bn);
+            }
+            for(size_t j=0;j<bn;++j) {
+                if(b[j]) {
+                    const digit_t carry = V::addmul_digit(r+j,a,an,b[j]);
+                    V::add_digits(r+j+an,n-j-an,&carry,1);
+                }
+            }
+        } else {
+            typename V::scratch_t product(an+bn);
+            V::mul_digits(product.data(),a,an,b,bn);
+            V::add_digits(r,n,product.data(),an+bn);
+        }
+    }
+
+    static void sub_term(digit_t *r, size_t n, const term &t) {
+        const digit_t *a = t.a->digits.data(), *b = t.b ? t.b->digits.data() : nullptr;
+        size_t an = t.a->rank(), bn = t.b ? t.b->rank() : 0;
+        if(!b) {
+            if(t.m == 1) {
+                V::sub_digits(r,n,a,an);
+            } else {
+                const digit_t borrow = V::submul_digit(r,a,an,t.m);
+                V::sub_digits(r+an,n-an,&borrow,1);
+            }
+        } else if(std::min(an,bn) < V::karatsuba_threshold) {
+            if(an < bn) {
+                std::swap(a,b);
+                std::swap(an,bn);
+            }
+            for(size_t j=0;j<bn;++j) {
+                if(b[j]) {
+                    const digit_t borrow = V::submul_digit(r+j,a,an,b[j]);
+                    V::sub_digits(r+j+an,n-j-an,&borrow,1);
+                }
+            }
+        } else {
+            typename V::scratch_t product(an+bn);
+            V::mul_digits(product.data(),a,an,b,bn);
+            V::sub_digits(r,n,product.data(),an+bn);
         }
-        return total;
     }
 
-    std::string toString(digit_t view_radix=10) const {
-        if(!rank()) return std::string("0");
+    // dst = sum of the terms, or dst += sum of the terms when keep is set.
+    // Positive terms go first, so no partial sum drops below the result.
+    void accumulate(V &dst, bool keep) const {
+        if(refers_to(&dst)) {
+            V result(dst.get_allocator());
+            if(keep) {
+                result = dst;
+            }
+            accumulate(result,keep);
+            dst = std::move(result);
+            return;
+        }
 
-        const bigint_t &view = (radix == view_radix) ? *this : convertToRadix(view_radix);
+        size_t top = keep ? dst.rank() : 0, positives = keep && dst.rank();
+        for(const term &t: list) {
+            const size_t rank = t.rank();
+            top = std::max(top,rank);
+            positives += rank && !t.negative;
+        }
+        if(!top) {
+            dst.digits.clear();
+            return;
+        }
 
-        const char *single_digits = "0123456789ABCDEFGHIJKLMNOPQRSTYVWXYZabcdefghijklmnopqrstyvwxyz";
-        const size_t digit_len = view_radix <= strlen(single_digits) ? 1 : (sizeof(digit_t)*2+2);
+        // room for the carries of adding up that many terms
+        size_t n = top + 1;
+        for(uint64_t bound=V::radix;bound < positives;bound *= V::radix) {
+            ++n;
+        }
 
-        auto buffer = std::make_unique<char[]>(view.rank()*digit_len);
-        char* out = buffer.get() + view.rank()*digit_len;
-        for(auto n: view.digits) {
-            if(digit_len == 1) {
-                *--out = single_digits[n];
-            } else {
-                *--out = ']';
-                for(size_t shift=0;shift < sizeof(digit_t)*8;shift += 4) {
-                    *--out = single_digits[(n >> shift) & 0xF];
-                }
-                *--out = '[';
+        if(!keep) {
+            dst.digits.clear();
+        }
+        dst.digits.resize(n);
+        digit_t *r = dst.digits.data();
+        for(const term &t: list) {
+            if(!t.negative && t.rank()) {
+                add_term(r,n,t);
+            }
+        }
+        for(const term &t: list) {
+            if(t.negative && t.rank()) {
+                sub_term(r,n,t);
             }
         }
+        dst.erase_leading_zeros();
+    }
+};
 
-        return std::string(out,view.rank()*digit_len);
+template<typename V, typename E>
+struct bigint_expr {
+    const E& self() const {
+        return static_cast<const E&>(*this);
     }
 
-    explicit operator bool() const {
-        return rank() != 0;
+    void evaluate(V &dst, bool keep, bool negative) const {
+        bigint_expr_terms<V> terms;
+        self().collect(terms,negative);
+        terms.accumulate(dst,keep);
     }
+};
 
-    bigint_t convertToRadix(digit_t new_radix) const {
-        bigint_t result(0,ceil(rank()/(log(new_radix)/log(radix))),new_radix);
-        bigint_t current(*this);
+template<typename V>
+struct bigint_expr_value: bigint_expr<V,bigint_expr_value<V>> {
+    const V &value;
 
-        for(bigint_t current=*this;current;current = current/new_radix) {
-            result.digits.push_back(current%new_radix);
-        }
+    explicit bigint_expr_value(const V &v):value(v) {
+
+    }
+
+    typename V::allocator_type get_allocator() const {
+        return value.get_allocator();
+    }
+
+    void collect(bigint_expr_terms<V> &terms, bool negative) const {
+        terms.add(&value,nullptr,1,negative);
+    }
+};
+
+// Factor of a product: values are used in place, anything else is evaluated first
+template<typename V, typename E>
+const V& bigint_expr_factor(const E &e, bigint_expr_terms<V> &terms) {
+    return terms.hold(V(e));
+}
+
+template<typename V>
+const V& bigint_expr_factor(const bigint_expr_value<V> &e, bigint_expr_terms<V> &) {
+    return e.value;
+}
+
+template<typename V, typename L, typename R, bool Subtract>
+struct bigint_expr_sum: bigint_expr<V,bigint_expr_sum<V,L,R,Subtract>> {
+    L left;
+    R right;
+
+    bigint_expr_sum(const L &l, const R &r):left(l),right(r) {
+
+    }
+
+    typename V::allocator_type get_allocator() const {
+        return left.get_allocator();
+    }
+
+    void collect(bigint_expr_terms<V> &terms, bool negative) const {
+        left.collect(terms,negative);
+        right.collect(terms,negative != Subtract);
+    }
+};
+
+template<typename V, typename L, typename R>
+struct bigint_expr_product: bigint_expr<V,bigint_expr_product<V,L,R>> {
+    L left;
+    R right;
+
+    bigint_expr_product(const L &l, const R &r):left(l),right(r) {
+
+    }
+
+    typename V::allocator_type get_allocator() const {
+        return left.get_allocator();
+    }
+
+    void collect(bigint_expr_terms<V> &terms, bool negative) const {
+        const V &a = bigint_expr_factor(left,terms);
+        const V &b = bigint_expr_factor(right,terms);
+        terms.add(&a,&b,1,negative);
+    }
+};
+
+template<typename V, typename E>
+struct bigint_expr_scaled: bigint_expr<V,bigint_expr_scaled<V,E>> {
+    E e;
+    uint64_t m;
+
+    bigint_expr_scaled(const E &e, uint64_t m):e(e),m(m) {
 
-        return result;
+    }
+
+    typename V::allocator_type get_allocator() const {
+        return e.get_allocator();
+    }
+
+    void collect(bigint_expr_terms<V> &terms, bool negative) const {
+        const V &a = bigint_expr_factor(e,terms);
+        if(m < V::radix) {
+            terms.add(&a,nullptr,(typename V::digit_t)m,negative);
+        } else {
+            terms.add(&a,&terms.hold(V(m,0,a.get_allocator())),1,negative);
+        }
     }
 };
 
+template<typename V, typename L, typename R>
+bigint_expr_sum<V,L,R,false> operator+(const bigint_expr<V,L> &l, const bigint_expr<V,R> &r) {
+    return bigint_expr_sum<V,L,R,false>(l.self(),r.self());
+}
+
+template<typename V, typename L>
+bigint_expr_sum<V,L,bigint_expr_value<V>,false> operator+(const bigint_expr<V,L> &l, const V &r) {
+    return bigint_expr_sum<V,L,bigint_expr_value<V>,false>(l.self(),bigint_expr_value<V>(r));
+}
+
+template<typename V, typename R>
+bigint_expr_sum<V,bigint_expr_value<V>,R,false> operator+(const V &l, const bigint_expr<V,R> &r) {
+    return bigint_expr_sum<V,bigint_expr_value<V>,R,false>(bigint_expr_value<V>(l),r.self());
+}
+
+template<typename V, typename L, typename R>
+bigint_expr_sum<V,L,R,true> operator-(const bigint_expr<V,L> &l, const bigint_expr<V,R> &r) {
+    return bigint_expr_sum<V,L,R,true>(l.self(),r.self());
+}
+
+template<typename V, typename L>
+bigint_expr_sum<V,L,bigint_expr_value<V>,true> operator-(const bigint_expr<V,L> &l, const V &r) {
+    return bigint_expr_sum<V,L,bigint_expr_value<V>,true>(l.self(),bigint_expr_value<V>(r));
+}
+
+template<typename V, typename R>
+bigint_expr_sum<V,bigint_expr_value<V>,R,true> operator-(const V &l, const bigint_expr<V,R> &r) {
+    return bigint_expr_sum<V,bigint_expr_value<V>,R,true>(bigint_expr_value<V>(l),r.self());
+}
+
+template<typename V, typename L, typename R>
+bigint_expr_product<V,L,R> operator*(const bigint_expr<V,L> &l, const bigint_expr<V,R> &r) {
+    return bigint_expr_product<V,L,R>(l.self(),r.self());
+}
+
+template<typename V, typename L>
+bigint_expr_product<V,L,bigint_expr_value<V>> operator*(const bigint_expr<V,L> &l, const V &r) {
+    return bigint_expr_product<V,L,bigint_expr_value<V>>(l.self(),bigint_expr_value<V>(r));
+}
+
+template<typename V, typename R>
+bigint_expr_product<V,bigint_expr_value<V>,R> operator*(const V &l, const bigint_expr<V,R> &r) {
+    return bigint_expr_product<V,bigint_expr_value<V>,R>(bigint_expr_value<V>(l),r.self());
+}
+
+template<typename V, typename E>
+bigint_expr_scaled<V,E> operator*(const bigint_expr<V,E> &e, uint64_t m) {
+    return bigint_expr_scaled<V,E>(e.self(),m);
+}
+
+template<typename V, typename E>
+bigint_expr_scaled<V,E> operator*(uint64_t m, const bigint_expr<V,E> &e) {
+    return bigint_expr_scaled<V,E>(e.self(),m);
+}
+
+typedef basic_bigint<(uint64_t)1 << 32,uint32_t> bigint_t;
+
+#if defined(BIGINT_HAS_PMR)
+// bigint_t drawing its limbs from a std::pmr::memory_resource, e.g. a monotonic
+// arena per request. Results of arithmetic take the allocator of the left operand.
+typedef basic_bigint<(uint64_t)1 << 32,uint32_t,std::pmr::polymorphic_allocator<uint32_t>> pmr_bigint_t;
+#endif
+typedef basic_bigint_divisor<(uint64_t)1 << 32,uint32_t> bigint_divisor;
+
 #endif // BIGINT_H
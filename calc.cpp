@@ -8,7 +8,7 @@ void show_result(const bigint_t &value) {
 
 int main(int argc, char **argv) {
     if(argc < 4) {
-        printf("Usage: %s {plus|minus|mul|div} arg1 arg2\n",argv[0]);
+        printf("Usage: %s {plus|minus|mul|div|mod} arg1 arg2\n",argv[0]);
         return 1;
     }
 
@@ -23,8 +23,10 @@ int main(int argc, char **argv) {
         show_result(arg1*arg2);
     } else if(strcmp(argv[1],"div") == 0) {
         show_result(arg1/arg2);
+    } else if(strcmp(argv[1],"mod") == 0) {
+        show_result(arg1%arg2);
     } else {
-        printf("Invalid operation[%s]. Available: {plus|minus|mul|div} \n",argv[1]);
+        printf("Invalid operation[%s]. Available: {plus|minus|mul|div|mod} \n",argv[1]);
         return 2;
     }
 
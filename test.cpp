@@ -3,6 +3,8 @@
 
 #include "bigint.h"
 
+#include <thread>
+
 TEST_CASE("bigint_t-1","") {
     const std::string &a_str = "123456789ABCDEF";
     bigint_t a(a_str,16);
@@ -36,3 +38,913 @@ TEST_CASE("bigint_t-2","") {
 
     REQUIRE((b/bigint_t(0x12345679)).toString(16) == "DFFFFFFB2200001C02DFFF64");
 }
+
+TEST_CASE("bigint_t-string-prefix","") {
+    REQUIRE(bigint_t("12x34",10) == bigint_t(12));
+    REQUIRE(bigint_t("-5",10) == bigint_t(0));
+    REQUIRE(bigint_t("",10) == bigint_t(0));
+    REQUIRE(bigint_t("FFz1",16) == bigint_t(0xFF));
+    REQUIRE(bigint_t("129",2) == bigint_t(1));
+}
+
+TEST_CASE("bigint_t-native-radix","") {
+    bigint_t a(0xFFFFFFFFull);
+    REQUIRE(a.radix == bigint_t::native_radix);
+    REQUIRE((a + bigint_t(1)).toString(16) == "100000000");
+    REQUIRE((bigint_t(0x100000000ull) - bigint_t(1)).toString(16) == "FFFFFFFF");
+    REQUIRE((a*a).toString(16) == "FFFFFFFE00000001");
+    REQUIRE(bigint_t(0x80000000ull) > bigint_t(1));
+
+    bigint_t b("FFFFFFFFFFFFFFFFFFFFFFFF",16);
+    REQUIRE(b.rank() == 3);
+    REQUIRE((b + bigint_t(1)).toString(16) == "1000000000000000000000000");
+    REQUIRE((b % 0xFFFFFFFF) == 0);
+    REQUIRE((b / 0x10000).toString(16) == "FFFFFFFFFFFFFFFFFFFF");
+}
+
+TEST_CASE("basic_bigint-radix","") {
+    typedef basic_bigint<1000000000> decimal_t;
+    typedef basic_bigint<1 << 16,uint16_t> short_t;
+
+    decimal_t a("123456789012345678901234567890",10);
+    REQUIRE(a.rank() == 4);
+    REQUIRE(a.digits[0] == 234567890);
+    REQUIRE((a*a + decimal_t(1)).toString() == "15241578753238836750495351562536198787501905199875019052101");
+
+    bigint_t b(a);
+    REQUIRE(b.toString() == a.toString());
+    REQUIRE(b.toString(16) == a.toString(16));
+    REQUIRE(b.convertToRadix<1000000000>() == a);
+
+    short_t c(b);
+    REQUIRE(c.rank() == 7);
+    REQUIRE((c*c).toString() == (a*a).toString());
+    REQUIRE(bigint_t(c) == b);
+}
+
+template<typename T>
+static T make_pattern(size_t n, uint32_t seed) {
+    T value(0,n);
+    for(size_t i=0;i<n;++i) {
+        seed = seed*1664525 + 1013904223;
+        value.digits.push_back(seed % T::radix);
+    }
+    value.digits.back() |= 1;
+    return value;
+}
+
+// Restores a tuning threshold when it goes out of scope, also when a REQUIRE throws
+struct threshold_guard {
+    size_t &threshold;
+    const size_t saved;
+
+    explicit threshold_guard(size_t &t):threshold(t),saved(t) {
+
+    }
+
+    ~threshold_guard() {
+        threshold = saved;
+    }
+};
+
+TEST_CASE("bigint_t-karatsuba","") {
+    typedef basic_bigint<1000000000> decimal_t;
+    const threshold_guard guard(bigint_t::karatsuba_threshold), decimal_guard(decimal_t::karatsuba_threshold);
+
+    for(size_t n: {40u,100u,257u}) {
+        for(size_t m: {(size_t)33,(size_t)90,n}) {
+            bigint_t a = make_pattern<bigint_t>(n,n), b = make_pattern<bigint_t>(m,m+1);
+            bigint_t full(0,n);
+            full.digits.assign(n,0xFFFFFFFF);
+
+            bigint_t::karatsuba_threshold = 8;
+            bigint_t fast = a*b, fast_full = full*full;
+            bigint_t::karatsuba_threshold = (size_t)-1;
+            REQUIRE(fast == a*b);
+            REQUIRE(fast_full == full*full);
+        }
+    }
+
+    decimal_t c = make_pattern<decimal_t>(120,7), d = make_pattern<decimal_t>(70,9);
+    decimal_t::karatsuba_threshold = 4;
+    decimal_t fast = c*d;
+    decimal_t::karatsuba_threshold = (size_t)-1;
+    REQUIRE(fast == c*d);
+
+    // thresholds below the smallest useful split still terminate
+    const bigint_t a = make_pattern<bigint_t>(37,10), b = make_pattern<bigint_t>(29,11);
+    const bigint_t expected = a*b;
+    for(size_t t: {0u,1u,3u}) {
+        bigint_t::karatsuba_threshold = t;
+        REQUIRE((a*b) == expected);
+    }
+}
+
+TEST_CASE("bigint_t-toom","") {
+    const threshold_guard k(bigint_t::karatsuba_threshold), t3(bigint_t::toom3_threshold), t4(bigint_t::toom4_threshold);
+
+    for(size_t n: {60u,301u}) {
+        for(size_t m: {(size_t)45,(size_t)230,n}) {
+            bigint_t a = make_pattern<bigint_t>(n,n+2), b = make_pattern<bigint_t>(m,m+3);
+            bigint_t full(0,n);
+            full.digits.assign(n,0xFFFFFFFF);
+
+            bigint_t::karatsuba_threshold = (size_t)-1;
+            bigint_t::toom3_threshold = (size_t)-1;
+            bigint_t::toom4_threshold = (size_t)-1;
+            const bigint_t expected = a*b, expected_full = full*full;
+
+            bigint_t::karatsuba_threshold = 4;
+            bigint_t::toom3_threshold = 12;
+            REQUIRE((a*b) == expected);
+            REQUIRE((full*full) == expected_full);
+
+            bigint_t::toom4_threshold = 20;
+            REQUIRE((a*b) == expected);
+            REQUIRE((full*full) == expected_full);
+        }
+    }
+}
+
+TEST_CASE("bigint_t-ntt","") {
+    typedef basic_bigint<1000000000> decimal_t;
+    typedef basic_bigint<1 << 16,uint16_t> short_t;
+    const threshold_guard ntt(bigint_t::ntt_threshold), decimal_ntt(decimal_t::ntt_threshold), short_ntt(short_t::ntt_threshold);
+
+    bigint_t a = make_pattern<bigint_t>(700,11), b = make_pattern<bigint_t>(450,12);
+    bigint_t full(0,600);
+    full.digits.assign(600,0xFFFFFFFF);
+    const bigint_t expected = a*b, expected_full = full*full, expected_mixed = full*a;
+
+    bigint_t::ntt_threshold = 40;
+    REQUIRE((a*b) == expected);
+    REQUIRE((full*full) == expected_full);
+    REQUIRE((full*a) == expected_mixed);
+
+    decimal_t c = make_pattern<decimal_t>(500,13), d = make_pattern<decimal_t>(300,14);
+    const decimal_t expected_dec = c*d;
+    decimal_t::ntt_threshold = 40;
+    REQUIRE((c*d) == expected_dec);
+
+    short_t e(a), f(b);
+    short_t::ntt_threshold = 40;
+    REQUIRE(bigint_t(e*f) == expected);
+}
+
+TEST_CASE("bigint_t-square","") {
+    REQUIRE(bigint_t(0).square() == bigint_t(0));
+    REQUIRE(bigint_t(0xFFFFFFFFull).square().toString(16) == "FFFFFFFE00000001");
+
+    for(size_t n: {1u,7u,90u,333u}) {
+        const threshold_guard k(bigint_t::karatsuba_threshold), ks(bigint_t::karatsuba_sqr_threshold);
+        const threshold_guard t3(bigint_t::toom3_threshold), t4(bigint_t::toom4_threshold), ntt(bigint_t::ntt_threshold);
+        bigint_t a = make_pattern<bigint_t>(n,n+5);
+        bigint_t full(0,n);
+        full.digits.assign(n,0xFFFFFFFF);
+
+        bigint_t::karatsuba_threshold = (size_t)-1;
+        const bigint_t expected = a*bigint_t(a), expected_full = full*bigint_t(full);
+        REQUIRE(a.square() == expected);
+        REQUIRE((full*full) == expected_full);
+
+        bigint_t::karatsuba_threshold = 4;
+        bigint_t::karatsuba_sqr_threshold = 4;
+        REQUIRE(a.square() == expected);
+        REQUIRE((full*full) == expected_full);
+
+        bigint_t::toom3_threshold = 12;
+        REQUIRE(a.square() == expected);
+        bigint_t::toom4_threshold = 20;
+        REQUIRE(a.square() == expected);
+        REQUIRE((full*full) == expected_full);
+
+        bigint_t::ntt_threshold = 40;
+        REQUIRE(a.square() == expected);
+        REQUIRE((full*full) == expected_full);
+
+        // thresholds below the smallest useful split still terminate
+        bigint_t::toom3_threshold = (size_t)-1;
+        bigint_t::toom4_threshold = (size_t)-1;
+        bigint_t::ntt_threshold = (size_t)-1;
+        for(size_t t: {0u,1u,3u}) {
+            bigint_t::karatsuba_sqr_threshold = t;
+            REQUIRE(a.square() == expected);
+        }
+    }
+}
+
+TEST_CASE("bigint_t-division","") {
+    REQUIRE((bigint_t(5)/bigint_t(7)) == bigint_t(0));
+    REQUIRE((bigint_t(7)/bigint_t(7)) == bigint_t(1));
+
+    // Needs the add-back step of Algorithm D
+    REQUIRE((bigint_t("7FFF800000000000000000000000",16)/bigint_t("800000000000000000000001",16)).toString(16) == "FFFE");
+
+    for(size_t n: {2u,5u,40u,300u}) {
+        for(size_t m: {(size_t)1,(size_t)3,n}) {
+            bigint_t a = make_pattern<bigint_t>(n,n+7), b = make_pattern<bigint_t>(m,m+8);
+            bigint_t rest = b - bigint_t(1);
+            REQUIRE(((a*b + rest)/b) == a);
+            REQUIRE(((a*b)/a) == b);
+        }
+    }
+
+    typedef basic_bigint<1000000000> decimal_t;
+    decimal_t c = make_pattern<decimal_t>(50,15), d = make_pattern<decimal_t>(20,16);
+    REQUIRE(((c*d + d - decimal_t(1))/d) == c);
+}
+
+TEST_CASE("bigint_t-recursive-division","") {
+    const threshold_guard bz(bigint_t::bz_threshold);
+
+    for(size_t n: {30u,97u,260u}) {
+        for(size_t m: {(size_t)9,(size_t)40,n}) {
+            bigint_t a = make_pattern<bigint_t>(n+m,n+17), b = make_pattern<bigint_t>(m,m+18);
+            bigint_t full(0,n+m);
+            full.digits.assign(n+m,0xFFFFFFFF);
+
+            bigint_t::bz_threshold = (size_t)-1;
+            const bigint_t expected = a/b, expected_full = full/b;
+            const bigint_t product = a*b + b - bigint_t(1);
+
+            bigint_t::bz_threshold = 4;
+            REQUIRE((a/b) == expected);
+            REQUIRE((full/b) == expected_full);
+            REQUIRE((product/b) == a);
+
+            // thresholds below the smallest useful split still terminate
+            bigint_t::bz_threshold = 1;
+            REQUIRE((a/b) == expected);
+            bigint_t::bz_threshold = 0;
+            REQUIRE((product/b) == a);
+        }
+    }
+}
+
+TEST_CASE("bigint_t-newton-division","") {
+    const threshold_guard bz(bigint_t::bz_threshold), newton(bigint_t::newton_threshold);
+
+    for(size_t n: {40u,200u,700u}) {
+        for(size_t m: {(size_t)8,(size_t)37,n}) {
+            bigint_t a = make_pattern<bigint_t>(n+m,n+23), b = make_pattern<bigint_t>(m,m+24);
+            bigint_t power(1,m-1);
+            bigint_t full(0,n+m);
+            full.digits.assign(n+m,0xFFFFFFFF);
+
+            bigint_t::bz_threshold = (size_t)-1;
+            const bigint_t expected = a/b, expected_full = full/b, expected_power = full/power;
+
+            bigint_t::bz_threshold = 4;
+            bigint_t::newton_threshold = 6;
+            REQUIRE((a/b) == expected);
+            REQUIRE((full/b) == expected_full);
+            REQUIRE((full/power) == expected_power);
+            REQUIRE(((a*b + b - bigint_t(1))/b) == a);
+        }
+    }
+}
+
+TEST_CASE("bigint_t-divmod","") {
+    for(size_t n: {1u,3u,90u,400u}) {
+        for(size_t m: {(size_t)1,(size_t)2,(size_t)70,n}) {
+            bigint_t a = make_pattern<bigint_t>(n,n+31), b = make_pattern<bigint_t>(m,m+32);
+            auto qr = divmod(a,b);
+            REQUIRE(qr.quotient == (a/b));
+            REQUIRE(qr.remainder < b);
+            REQUIRE((qr.quotient*b + qr.remainder) == a);
+            REQUIRE((a%b) == qr.remainder);
+
+            bigint_t c = a;
+            c %= b;
+            REQUIRE(c == qr.remainder);
+            c = a;
+            c /= b;
+            REQUIRE(c == qr.quotient);
+        }
+    }
+
+    bigint_t a("123456789ABCDEF0123456789ABCDEF",16);
+    REQUIRE((a%bigint_t(0x12345679)).toString(16) == "C637BE7");
+    a %= a;
+    REQUIRE(!a);
+}
+
+TEST_CASE("bigint_limb_divisor","") {
+    uint64_t seed = 12345;
+    for(uint64_t d: {1ull,2ull,3ull,7ull,10ull,1000000000ull,0x12345679ull,0x7FFFFFFFull,0x80000001ull,0xFFFFFFFFull,0x100000000ull}) {
+        const bigint_limb_divisor divisor(d);
+        for(size_t i=0;i<1000;++i) {
+            seed = seed*6364136223846793005ull + 1442695040888963407ull;
+            const uint64_t x = i < 2 ? (i ? d*((uint64_t)1 << 32)-1 : 0) : (seed >> 1) % (d << 32 ? d << 32 : ~0ull);
+            uint64_t rem;
+            const uint64_t q = divisor.divide(x,rem);
+            REQUIRE(q == x/d);
+            REQUIRE(rem == x%d);
+        }
+    }
+
+    typedef basic_bigint<1000000000> decimal_t;
+    bigint_t a = make_pattern<bigint_t>(60,41);
+    decimal_t b(a);
+    for(uint32_t n: {3u,10u,999999937u,0xFFFFFFFBu}) {
+        REQUIRE((a/n*bigint_t(n) + bigint_t(a%n)) == a);
+        if(n < decimal_t::radix) {
+            REQUIRE((b/n*decimal_t(n) + decimal_t(b%n)) == b);
+            REQUIRE((b%n) == (a%n));
+        }
+    }
+    REQUIRE(decimal_t(bigint_t("FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF",16)).toString(10) == "340282366920938463463374607431768211455");
+}
+
+TEST_CASE("bigint_t-to-digits","") {
+    typedef basic_bigint<1 << 16,uint16_t> short_t;
+    const bigint_t a = make_pattern<bigint_t>(40,51);
+    const short_t b(a);
+
+    for(uint64_t view_radix: {2ull,3ull,10ull,36ull,65536ull,1000000007ull,0xFFFFFFFFull,0x100000000ull}) {
+        const std::vector<uint32_t> digits = a.toDigits(view_radix);
+        REQUIRE(digits.back() != 0);
+        REQUIRE(b.toDigits(view_radix) == digits);
+
+        bigint_t back;
+        for(auto i=digits.rbegin();i!=digits.rend();++i) {
+            back.mul_add(view_radix,*i);
+        }
+        REQUIRE(back == a);
+    }
+}
+
+TEST_CASE("bigint_t-divisor","") {
+    const threshold_guard bz(bigint_t::bz_threshold), newton(bigint_t::newton_threshold);
+
+    for(size_t m: {1u,2u,30u,150u}) {
+        const bigint_t b = make_pattern<bigint_t>(m,m+61);
+        bigint_t::bz_threshold = 8;
+        bigint_t::newton_threshold = 40;
+        const bigint_divisor d(b);
+
+        for(size_t n: {(size_t)0,(size_t)1,m,2*m+5,5*m+20}) {
+            const bigint_t a = n ? make_pattern<bigint_t>(n,n+62) : bigint_t();
+            auto expected = divmod(a,b);
+            auto qr = d.divmod(a);
+            REQUIRE(qr.quotient == expected.quotient);
+            REQUIRE(qr.remainder == expected.remainder);
+            REQUIRE(d.div(a) == expected.quotient);
+            REQUIRE(d.mod(a) == expected.remainder);
+        }
+    }
+
+    typedef basic_bigint<1000000000> decimal_t;
+    const decimal_t c = make_pattern<decimal_t>(12,63);
+    const basic_bigint_divisor<1000000000> e(c);
+    const decimal_t a = make_pattern<decimal_t>(40,64);
+    REQUIRE(e.div(a) == (a/c));
+    REQUIRE(e.mod(a) == (a%c));
+}
+
+TEST_CASE("bigint_t-radix-conversion","") {
+    typedef basic_bigint<1000000000> decimal_t;
+    typedef basic_bigint<1 << 16,uint16_t> short_t;
+
+    for(size_t n: {3u,40u,150u,600u}) {
+        const threshold_guard guard(bigint_t::radix_dc_threshold), decimal_guard(decimal_t::radix_dc_threshold);
+        const threshold_guard short_guard(short_t::radix_dc_threshold);
+        const bigint_t a = make_pattern<bigint_t>(n,n+71);
+        bigint_t full(0,n);
+        full.digits.assign(n,0xFFFFFFFF);
+
+        bigint_t::radix_dc_threshold = (size_t)-1;
+        decimal_t::radix_dc_threshold = (size_t)-1;
+        const std::string expected = a.toString(10), expected_full = full.toString(10);
+        const std::string expected7 = a.toString(7);
+        const decimal_t expected_decimal(a);
+
+        // 0 and 1 are below the smallest useful split and must still terminate
+        for(size_t t: {0u,1u,2u,5u,32u}) {
+            bigint_t::radix_dc_threshold = t;
+            decimal_t::radix_dc_threshold = t;
+            short_t::radix_dc_threshold = t;
+            REQUIRE(a.toString(10) == expected);
+            REQUIRE(full.toString(10) == expected_full);
+            REQUIRE(a.toString(7) == expected7);
+            REQUIRE(bigint_t(expected,10) == a);
+            REQUIRE(bigint_t(expected_full,10) == full);
+            REQUIRE(bigint_t(expected7,7) == a);
+            REQUIRE(decimal_t(a) == expected_decimal);
+            REQUIRE(bigint_t(expected_decimal) == a);
+            REQUIRE(bigint_t(short_t(expected_decimal)) == a);
+            REQUIRE(expected_decimal.toString(10) == expected);
+        }
+    }
+
+    REQUIRE(bigint_t("1" + std::string(5000,'0'),10).toString(10) == "1" + std::string(5000,'0'));
+
+    // Values just short of twice a power that doubled the previous one still split
+    const threshold_guard guard(bigint_t::radix_dc_threshold);
+    bigint_t::power_tree &tree = bigint_t::shared_power_tree(10);
+    size_t l = 3;
+    for(;tree.power(l).rank() != 2*tree.power(l-1).rank();++l);
+    for(size_t n: {2*tree.power(l).rank()-3,2*tree.power(l).rank()-2}) {
+        const bigint_t a = make_pattern<bigint_t>(n,n+73);
+        bigint_t::radix_dc_threshold = (size_t)-1;
+        const std::string expected = a.toString(10);
+        bigint_t::radix_dc_threshold = 4;
+        REQUIRE(a.toString(10) == expected);
+        REQUIRE(bigint_t(expected,10) == a);
+    }
+}
+
+TEST_CASE("bigint_t-shared-power-tree","") {
+    const threshold_guard guard(bigint_t::radix_dc_threshold);
+    bigint_t::radix_dc_threshold = 4;
+
+    std::vector<bigint_t> values;
+    std::vector<std::string> expected;
+    for(size_t n: {10u,60u,200u,90u}) {
+        values.push_back(make_pattern<bigint_t>(n,n+81));
+        expected.push_back(values.back().toString(10));
+    }
+
+    bigint_t::power_tree &tree = bigint_t::shared_power_tree(10);
+    REQUIRE(&tree == &bigint_t::shared_power_tree(10));
+    REQUIRE(&tree != &bigint_t::shared_power_tree(7));
+    REQUIRE(tree.base == 1000000000);
+    REQUIRE(tree.powers.size() > 1);
+
+    std::vector<std::thread> threads;
+    std::vector<int> ok(4,0);
+    for(size_t t=0;t<ok.size();++t) {
+        threads.emplace_back([&,t]() {
+            int good = 1;
+            for(size_t i=0;i<values.size();++i) {
+                const bigint_t v = values[(i+t) % values.size()] * bigint_t(t+1);
+                good &= bigint_t(v.toString(10),10) == v;
+                good &= values[i].toString(10) == expected[i];
+            }
+            ok[t] = good;
+        });
+    }
+    for(auto &t: threads) {
+        t.join();
+    }
+    REQUIRE(std::count(ok.begin(),ok.end(),1) == (int)ok.size());
+}
+
+TEST_CASE("bigint_t-chunked-parsing","") {
+    const char *alphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    uint32_t seed = 91;
+    for(uint32_t radix: {2u,10u,16u,36u,62u}) {
+        for(size_t len=1;len<=70;len+=3) {
+            std::string s;
+            bigint_t expected;
+            for(size_t i=0;i<len;++i) {
+                seed = seed*1664525 + 1013904223;
+                const uint32_t digit = i ? (seed >> 8) % radix : 0;
+                s.push_back(alphabet[digit]);
+                expected.mul_add(radix,digit);
+            }
+            REQUIRE(bigint_t(s,radix) == expected);
+            REQUIRE(bigint_t(s + "-12",radix) == expected);
+        }
+    }
+
+    REQUIRE(!bigint_t("",10));
+    REQUIRE(!bigint_t("000000000000000000000",10));
+    REQUIRE(bigint_t("18446744073709551616",10).toString(16) == "10000000000000000");
+}
+
+TEST_CASE("bigint-decimal-kernels","") {
+    const uint32_t edges[] = {0,1,9,10,10000,99999999,100000000,100000001,123456789,999999999};
+    uint32_t seed = 7;
+    char buffer[16];
+    for(size_t i=0;i<20000;++i) {
+        seed = seed*1664525 + 1013904223;
+        const uint32_t x = i < 10 ? edges[i] : seed % 1000000000;
+        bigint_format_decimal9(x,buffer);
+        char expected[16];
+        snprintf(expected,sizeof(expected),"%09u",x);
+        REQUIRE(std::string(buffer,9) == expected);
+        REQUIRE(bigint_parse_decimal8(expected+1) == x % 100000000);
+    }
+
+    const std::string digits = "0123456789012345678901234567890123456789012345678901234567890123456789";
+    for(size_t stop=0;stop<digits.size();stop+=7) {
+        std::string s = digits;
+        s[stop] = '/';
+        REQUIRE(bigint_scan_decimal(s.data(),s.size(),10) == stop);
+        s[stop] = ':';
+        REQUIRE(bigint_scan_decimal(s.data(),s.size(),10) == stop);
+    }
+    REQUIRE(bigint_scan_decimal(digits.data(),digits.size(),10) == digits.size());
+    REQUIRE(bigint_scan_decimal(digits.data(),digits.size(),8) == 8);
+    REQUIRE(bigint_scan_decimal("0110201",7,2) == 4);
+}
+
+TEST_CASE("bigint_t-to-chars","") {
+    typedef basic_bigint<10> digit_t;
+    char buffer[4096];
+
+    for(size_t n: {1u,2u,7u,60u,300u}) {
+        const bigint_t a = make_pattern<bigint_t>(n,n+97);
+        for(uint64_t view_radix: {2ull,10ull,16ull,36ull,62ull,1000ull,0x100000000ull}) {
+            const std::string expected = a.toString(view_radix);
+            REQUIRE(a.size_in_base(view_radix) >= expected.size());
+
+            auto written = a.to_chars(buffer,buffer+sizeof(buffer),view_radix);
+            if(expected.size() > sizeof(buffer)) {
+                REQUIRE(written.ec == std::errc::value_too_large);
+                continue;
+            }
+            REQUIRE(written.ec == std::errc());
+            REQUIRE(std::string(buffer,written.ptr) == expected);
+
+            written = a.to_chars(buffer,buffer+expected.size()-1,view_radix);
+            REQUIRE(written.ec == std::errc::value_too_large);
+            REQUIRE(written.ptr == buffer+expected.size()-1);
+        }
+    }
+
+    auto written = bigint_t().to_chars(buffer,buffer+1);
+    REQUIRE(std::string(buffer,written.ptr) == "0");
+    REQUIRE(bigint_t().to_chars(buffer,buffer).ec == std::errc::value_too_large);
+
+    const digit_t d("9081726354",10);
+    written = d.to_chars(buffer,buffer+10);
+    REQUIRE(std::string(buffer,written.ptr) == "9081726354");
+    REQUIRE(bigint_t(d).toString() == "9081726354");
+    REQUIRE(bigint_t(1000000000).toString() == "1000000000");
+    REQUIRE(bigint_t(999999999).toString() == "999999999");
+}
+
+TEST_CASE("bigint_t-from-chars","") {
+    const std::string text = "12345678901234567890123456789012345678901234567890 rest";
+    bigint_t a;
+    auto parsed = a.from_chars(text.data(),text.data()+text.size());
+    REQUIRE(parsed.ec == std::errc());
+    REQUIRE(parsed.ptr == text.data()+50);
+    REQUIRE(a.toString() == text.substr(0,50));
+
+    for(size_t len: {1u,9u,10u,17u,18u,33u}) {
+        parsed = a.from_chars(text.data(),text.data()+len);
+        REQUIRE(parsed.ptr == text.data()+len);
+        REQUIRE(a.toString() == text.substr(0,len));
+    }
+
+    parsed = a.from_chars(text.data()+50,text.data()+text.size());
+    REQUIRE(parsed.ec == std::errc::invalid_argument);
+    REQUIRE(parsed.ptr == text.data()+50);
+    REQUIRE(a.toString() == text.substr(0,33));
+
+    const char hex[] = {'F','E','0','1','g'};
+    parsed = a.from_chars(hex,hex+sizeof(hex),16);
+    REQUIRE((parsed.ptr - hex) == 4);
+    REQUIRE(a == bigint_t(0xFE01));
+    REQUIRE((a.from_chars(hex,hex+sizeof(hex),62).ptr - hex) == 5);
+
+    // bytes outside ASCII end the number, whatever the locale
+    const char latin[] = {'z','1',(char)0xE9,'2'};
+    parsed = a.from_chars(latin,latin+sizeof(latin),62);
+    REQUIRE((parsed.ptr - latin) == 2);
+    REQUIRE(a == bigint_t(61*62 + 1));
+    for(int c=0x80;c < 0x100;++c) {
+        REQUIRE(bigint_t::char_value((char)c) == 255);
+    }
+
+#if __cplusplus >= 201703L
+    const std::string_view view(text.data()+10,20);
+    REQUIRE(bigint_t(view,10).toString() == "12345678901234567890");
+#endif
+}
+
+TEST_CASE("bigint_t-pow2-radix","") {
+    typedef basic_bigint<1 << 16,uint16_t> short_t;
+    typedef basic_bigint<8> octal_t;
+    const char *alphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+
+    for(size_t n: {1u,2u,5u,33u,200u}) {
+        const bigint_t a = make_pattern<bigint_t>(n,n+111);
+        const short_t b(a);
+        const octal_t c(a);
+        REQUIRE(b.rank() >= 2*n-1);
+        REQUIRE(bigint_t(b) == a);
+        REQUIRE(bigint_t(c) == a);
+        REQUIRE(short_t(c) == b);
+
+        for(uint64_t view_radix: {2ull,4ull,8ull,16ull,32ull}) {
+            // reference digits by repeated division
+            std::string expected;
+            for(bigint_t current=a;current;) {
+                expected.push_back(alphabet[current.divmod_small(view_radix)]);
+            }
+            std::reverse(expected.begin(),expected.end());
+
+            REQUIRE(a.toString(view_radix) == expected);
+            REQUIRE(b.toString(view_radix) == expected);
+            REQUIRE(c.toString(view_radix) == expected);
+            REQUIRE(bigint_t(expected,view_radix) == a);
+            REQUIRE(short_t(expected,view_radix) == b);
+            REQUIRE(octal_t(expected,view_radix) == c);
+
+            const std::vector<uint32_t> digits = a.toDigits(view_radix);
+            REQUIRE(digits.size() == expected.size());
+            REQUIRE(digits.back() == (uint32_t)(strchr(alphabet,expected[0]) - alphabet));
+        }
+        REQUIRE(b.toDigits(1 << 8) == a.toDigits(1 << 8));
+    }
+
+    REQUIRE(bigint_t("0000000000000000000000000001",16).toString(16) == "1");
+    REQUIRE(bigint_t("0000",16).rank() == 0);
+}
+
+TEST_CASE("bigint_t-inline-limbs","") {
+    const bigint_t small("FFFFFFFFFFFFFFFFFFFFFFFF",16);
+    REQUIRE(small.digits.capacity() == bigint_t::inline_limbs);
+    REQUIRE((const void*)small.digits.data() >= (const void*)&small);
+    REQUIRE((const void*)small.digits.data() < (const void*)(&small+1));
+
+    // containers of values move them on reallocation instead of copying
+    REQUIRE(std::is_nothrow_move_constructible<bigint_t>::value);
+    REQUIRE(std::is_nothrow_move_assignable<bigint_t>::value);
+
+    bigint_t product = small*small;
+    REQUIRE(product.rank() > bigint_t::inline_limbs);
+    REQUIRE(product.toString(16) == "FFFFFFFFFFFFFFFFFFFFFFFE000000000000000000000001");
+
+    bigint_t moved(std::move(product));
+    REQUIRE(moved.toString(16) == "FFFFFFFFFFFFFFFFFFFFFFFE000000000000000000000001");
+    REQUIRE(product.rank() == 0);
+
+    bigint_t copy = small;
+    copy.digits.swap(moved.digits);
+    REQUIRE(copy.toString(16) == "FFFFFFFFFFFFFFFFFFFFFFFE000000000000000000000001");
+    REQUIRE(moved == small);
+    moved = std::move(copy);
+    REQUIRE(moved.rank() == 6);
+    copy = small;
+    REQUIRE(copy == small);
+
+    bigint_t grown;
+    for(uint32_t i=1;i<=100;++i) {
+        grown.digits.push_back(i);
+    }
+    REQUIRE(grown.rank() == 100);
+    REQUIRE(grown.digits.back() == 100);
+    grown = small;
+    REQUIRE(grown == small);
+
+    typedef basic_bigint<1 << 16,uint16_t> short_t;
+    REQUIRE(short_t::inline_limbs == 8);
+}
+
+template<typename T>
+struct counting_allocator {
+    typedef T value_type;
+    size_t *count;
+
+    // no default constructor: every value must get its allocator from an operand
+    explicit counting_allocator(size_t *c):count(c) {}
+    template<typename U> counting_allocator(const counting_allocator<U> &other):count(other.count) {}
+
+    T* allocate(size_t n) {
+        ++*count;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, size_t n) {
+        std::allocator<T>().deallocate(p,n);
+    }
+
+    bool operator==(const counting_allocator &other) const { return count == other.count; }
+    bool operator!=(const counting_allocator &other) const { return count != other.count; }
+};
+
+TEST_CASE("bigint_t-allocator","") {
+    typedef basic_bigint<(uint64_t)1 << 32,uint32_t,counting_allocator<uint32_t>> counted_t;
+
+    size_t allocations = 0;
+    const counting_allocator<uint32_t> alloc(&allocations);
+    const bigint_t x = make_pattern<bigint_t>(40,121), y = make_pattern<bigint_t>(15,122);
+    const counted_t a(x,alloc), b(y,alloc);
+    REQUIRE(allocations == 2);
+    REQUIRE(bigint_t(a) == x);
+
+    const counted_t product = a*b;
+    REQUIRE(product.get_allocator() == alloc);
+    REQUIRE(allocations == 3);
+    REQUIRE(bigint_t(product) == (x*y));
+    REQUIRE(((a+b) - b).get_allocator() == alloc);
+    REQUIRE((product/b) == a);
+    REQUIRE((product/b).get_allocator() == alloc);
+    REQUIRE((a << 3).get_allocator() == alloc);
+    REQUIRE(a.toString() == x.toString());
+
+    counted_t parsed(alloc);
+    const std::string text = x.toString();
+    parsed.from_chars(text.data(),text.data()+text.size());
+    REQUIRE(parsed == a);
+    REQUIRE(parsed.get_allocator() == alloc);
+
+    // moving between different allocators copies instead of adopting the buffer
+    size_t other_allocations = 0;
+    const counting_allocator<uint32_t> other_alloc(&other_allocations);
+    counted_t other(other_alloc);
+    other = counted_t(a);
+    REQUIRE(other == a);
+    REQUIRE(other.get_allocator() != alloc);
+
+    // Toom, recursive and Newton division temporaries stay off the caller's allocator
+    const bigint_t big_x = make_pattern<bigint_t>(2000,123), big_y = make_pattern<bigint_t>(1000,124);
+    const counted_t big_a(big_x,alloc), big_b(big_y,alloc);
+    size_t before = allocations;
+    const counted_t big_product = big_a*big_b;
+    REQUIRE(allocations == before+1);
+    REQUIRE(bigint_t(big_product) == big_x*big_y);
+
+    const bigint_t u = make_pattern<bigint_t>(300,125), v = make_pattern<bigint_t>(200,126);
+    const counted_t cu(u,alloc), cv(v,alloc);
+    before = allocations;
+    const auto qr = divmod(cu,cv);
+    REQUIRE(allocations == before+2);
+    REQUIRE(bigint_t(qr.quotient) == u/v);
+    REQUIRE(bigint_t(qr.remainder) == u%v);
+    {
+        // the kernels of other allocators run on bigint_t, with its thresholds
+        const threshold_guard newton(bigint_t::newton_threshold);
+        bigint_t::newton_threshold = 40;
+        const bigint_t w = make_pattern<bigint_t>(400,127);
+        const counted_t cw(w,alloc);
+        before = allocations;
+        REQUIRE(bigint_t(cw/cv) == w/v);
+        REQUIRE(allocations == before+2);
+
+        before = allocations;
+        const basic_bigint_divisor<(uint64_t)1 << 32,uint32_t,counting_allocator<uint32_t>> d(cv);
+        REQUIRE(allocations == before+1);
+        const auto dqr = d.divmod(cw);
+        REQUIRE(allocations == before+3);
+        REQUIRE(bigint_t(dqr.quotient) == w/v);
+        REQUIRE(bigint_t(dqr.remainder) == w%v);
+    }
+
+#if defined(BIGINT_HAS_PMR)
+    char buffer[1 << 14];
+    std::pmr::monotonic_buffer_resource arena(buffer,sizeof(buffer),std::pmr::null_memory_resource());
+    const pmr_bigint_t c(x,&arena), d(y,&arena);
+    const pmr_bigint_t e = c*d + c;
+    REQUIRE(e.get_allocator().resource() == &arena);
+    REQUIRE(bigint_t(e) == (x*y + x));
+    REQUIRE(e.toString(16) == (x*y + x).toString(16));
+    const pmr_bigint_t f = c/7u;
+    REQUIRE(f.get_allocator().resource() == &arena);
+    REQUIRE(bigint_t(f) == x/7u);
+
+    // nothing may fall back to the default resource, which throws here
+    struct default_resource_guard {
+        std::pmr::memory_resource *saved = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        ~default_resource_guard() { std::pmr::set_default_resource(saved); }
+    } guard;
+    std::vector<char> space(1 << 20);
+    std::pmr::monotonic_buffer_resource request(space.data(),space.size(),std::pmr::null_memory_resource());
+    const pmr_bigint_t pa(big_x,&request), pb(big_y,&request), pu(u,&request), pv(v,&request);
+    const pmr_bigint_t pp = pa*pb;
+    REQUIRE(pp.get_allocator().resource() == &request);
+    REQUIRE(bigint_t(pp) == big_x*big_y);
+    const pmr_bigint_t pq = pu/pv;
+    REQUIRE(pq.get_allocator().resource() == &request);
+    REQUIRE(bigint_t(pq) == u/v);
+    REQUIRE(pp.toString() == (big_x*big_y).toString());
+    pmr_bigint_t parsed_pp(&request);
+    const std::string pp_text = pp.toString();
+    parsed_pp.from_chars(pp_text.data(),pp_text.data()+pp_text.size());
+    REQUIRE(parsed_pp == pp);
+#endif
+}
+
+TEST_CASE("bigint_limb_pool","") {
+    void *p = bigint_limb_pool::allocate(100);
+    bigint_limb_pool::deallocate(p,100);
+    void *q = bigint_limb_pool::allocate(120);
+    REQUIRE(q == p);
+    bigint_limb_pool::deallocate(q,120);
+
+    void *huge = bigint_limb_pool::allocate((size_t)1 << 22);
+    bigint_limb_pool::deallocate(huge,(size_t)1 << 22);
+
+    // a buffer freed on another thread joins that thread's cache
+    bigint_t a = make_pattern<bigint_t>(50,131);
+    std::thread([&a]() {
+        bigint_t b = std::move(a);
+        b = b*b;
+        REQUIRE(b.rank() == 100);
+    }).join();
+
+    const bigint_t x = make_pattern<bigint_t>(90,132), y = make_pattern<bigint_t>(40,133);
+    const bigint_t expected = x*y;
+    for(size_t i=0;i<10;++i) {
+        REQUIRE((x*y) == expected);
+        REQUIRE(((expected + y - bigint_t(1))/y) == x);
+    }
+}
+
+TEST_CASE("bigint_t-expressions","") {
+    for(size_t n: {0,1,3,20,40,90}) {
+        const bigint_t a = n ? make_pattern<bigint_t>(n,n+141) : bigint_t();
+        const bigint_t b = make_pattern<bigint_t>(n/2+1,n+142);
+        const bigint_t c = make_pattern<bigint_t>(n+5,n+143);
+        const bigint_t d = make_pattern<bigint_t>(n/3+1,n+144) % b;
+
+        const bigint_t sum = a.lazy() + b.lazy()*c - d;
+        REQUIRE(sum == a + b*c - d);
+
+        bigint_t product = a.lazy()*b + c.lazy()*c + d.lazy()*7 - a.lazy()*0x100000003ULL;
+        REQUIRE(product == a*b + c*c + d*bigint_t(7) - a*bigint_t(0x100000003ULL));
+
+        REQUIRE(bigint_t((a.lazy() + b)*(c.lazy() - d)) == (a + b)*(c - d));
+        REQUIRE(bigint_t(c.lazy() - (b.lazy() - d)) == c - (b - d));
+
+        bigint_t x = a;
+        x += b.lazy()*c;
+        REQUIRE(x == a + b*c);
+        x -= b.lazy()*c - d;
+        REQUIRE(x == a + d);
+
+        // the destination may appear in its own expression
+        x = x.lazy()*x + x - d;
+        REQUIRE(x == (a + d)*(a + d) + a);
+        x -= x.lazy();
+        REQUIRE(x == bigint_t());
+    }
+
+    typedef basic_bigint<1000000000> decimal_t;
+    const decimal_t c = make_pattern<decimal_t>(50,145), d = make_pattern<decimal_t>(45,146);
+    const decimal_t e = c.lazy()*d + c*999999999ULL - d.lazy()*3;
+    REQUIRE(e == c*d + c*decimal_t(999999999) - d*decimal_t(3));
+}
+
+TEST_CASE("bigint_t-in-place","") {
+    for(size_t n: {1,2,5,40,120}) {
+        const bigint_t a = make_pattern<bigint_t>(n,n+151), b = make_pattern<bigint_t>(n/2+1,n+152);
+
+        bigint_t x = a;
+        x *= b;
+        REQUIRE(x == a*b);
+        x = b;
+        x *= a;
+        REQUIRE(x == a*b);
+        x *= x;
+        REQUIRE(x == (a*b)*(a*b));
+        x *= bigint_t();
+        REQUIRE(x == bigint_t());
+
+        x = a;
+        x <<= 7;
+        REQUIRE(x == (a << 7));
+        x >>= 3;
+        REQUIRE(x == (a << 4));
+        x >>= 4;
+        REQUIRE(x == a);
+        x >>= n;
+        REQUIRE(x == bigint_t());
+        x <<= 5;
+        REQUIRE(x == bigint_t());
+
+        for(size_t k: {(size_t)0,(size_t)1,(size_t)3,n}) {
+            x = a;
+            x.add_shifted(b,k);
+            REQUIRE(x == a + (b << k));
+            REQUIRE(x.compare_shifted(b,k) > 0);
+            REQUIRE((b << k).compare_shifted(b,k) == 0);
+            REQUIRE(b.compare_shifted(b,k+1) < 0);
+            x.sub_shifted(b,k);
+            REQUIRE(x == a);
+            x.add_shifted(x,k);
+            REQUIRE(x == a + (a << k));
+        }
+    }
+}
+
+TEST_CASE("bigint_t-rvalue-operators","") {
+    const bigint_t a = make_pattern<bigint_t>(60,161), b = make_pattern<bigint_t>(40,162), c = make_pattern<bigint_t>(70,163);
+    const bigint_t sum = a + b + c - b;
+    REQUIRE(sum == a + c);
+
+    bigint_t t = a;
+    t.digits.reserve(80);
+    const uint32_t *buffer = t.digits.data();
+    bigint_t r = std::move(t) + b;
+    REQUIRE(r == a + b);
+    REQUIRE(r.digits.data() == buffer);
+
+    r = (std::move(r) - b) << 3;
+    REQUIRE(r == (a << 3));
+    REQUIRE(r.digits.data() == buffer);
+
+    r = c + (std::move(r) >> 3);
+    REQUIRE(r == a + c);
+    REQUIRE(r.digits.data() == buffer);
+
+    r = bigint_t(a) + bigint_t(b);
+    REQUIRE(r == a + b);
+    r = a + r;
+    REQUIRE(r == a + a + b);
+}
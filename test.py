@@ -26,3 +26,4 @@ if __name__ == '__main__':
     test_operation('plus',lambda a,b: a+b);
     test_operation('mul',lambda a,b: a*b);
     test_operation('div',lambda a,b: a/b);
+    test_operation('mod',lambda a,b: a%b);